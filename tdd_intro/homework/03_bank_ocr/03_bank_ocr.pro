@@ -1,9 +1,29 @@
 include(../../gtest.pri)
 
 TEMPLATE = app
-CONFIG += console c++11
+CONFIG += console c++14
 CONFIG -= app_bundle
 CONFIG -= qt
 
 SOURCES += \
-    test.cpp
+    test.cpp \
+    benchmark.cpp \
+    ocr.cpp \
+    glyphkernels.cpp \
+    ingest.cpp \
+    validation.cpp \
+    report.cpp \
+    correction.cpp \
+    follow.cpp \
+    accountstore.cpp
+
+HEADERS += \
+    ocr.h \
+    glyphkernels.h \
+    ingest.h \
+    validation.h \
+    report.h \
+    correction.h \
+    font.h \
+    follow.h \
+    accountstore.h
@@ -0,0 +1,326 @@
+#include "accountstore.h"
+#include <algorithm>
+
+namespace
+{
+    const size_t s_initialSlots = 16;
+    const unsigned s_bloomBitsPerAccount = 10;
+    const unsigned s_bloomHashes = 7;
+    const uint32_t s_accountsPerBlock = 128;
+    // Pending accounts are merged once there are this many, or 1/8 of the store, whatever is bigger
+    const size_t s_minPendingToCompact = 4096;
+    const size_t s_pendingFractionToCompact = 8;
+
+    uint64_t Mix(uint64_t value)
+    {
+        value += 0x9E3779B97F4A7C15ull;
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+        return value ^ (value >> 31);
+    }
+
+    void WriteVarint(uint32_t value, std::vector<uint8_t>& out)
+    {
+        while (value >= 0x80)
+        {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    uint32_t ReadVarint(const uint8_t*& in)
+    {
+        uint32_t value = 0;
+        for (unsigned shift = 0; ; shift += 7)
+        {
+            const uint8_t byte = *in++;
+            value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+            {
+                return value;
+            }
+        }
+    }
+}
+
+// Taken by reference by the vector and std::fill, so it needs a definition
+const uint32_t AccountHashSet::s_emptySlot;
+
+bool ocr::PackAccount(const char account[g_digitsOnDisplay], uint32_t& packed)
+{
+    packed = 0;
+    for (unsigned short position = 0; position < g_digitsOnDisplay; ++position)
+    {
+        const unsigned digit = static_cast<unsigned>(account[position] - '0');
+        if (digit > 9)
+        {
+            return false;
+        }
+        packed = packed * 10 + digit;
+    }
+    return true;
+}
+
+std::string ocr::UnpackAccount(uint32_t packed)
+{
+    std::string account(g_digitsOnDisplay, '0');
+    for (size_t position = g_digitsOnDisplay; position-- > 0; packed /= 10)
+    {
+        account[position] = static_cast<char>('0' + packed % 10);
+    }
+    return account;
+}
+
+AccountHashSet::AccountHashSet()
+    : m_slots(s_initialSlots, s_emptySlot)
+    , m_size(0)
+{
+}
+
+bool AccountHashSet::Insert(uint32_t account)
+{
+    if ((m_size + 1) * 2 > m_slots.size())
+    {
+        Grow();
+    }
+
+    const size_t mask = m_slots.size() - 1;
+    for (size_t slot = SlotOf(account); ; slot = (slot + 1) & mask)
+    {
+        if (m_slots[slot] == account)
+        {
+            return false;
+        }
+        if (m_slots[slot] == s_emptySlot)
+        {
+            m_slots[slot] = account;
+            ++m_size;
+            return true;
+        }
+    }
+}
+
+bool AccountHashSet::Contains(uint32_t account) const
+{
+    const size_t mask = m_slots.size() - 1;
+    for (size_t slot = SlotOf(account); m_slots[slot] != s_emptySlot; slot = (slot + 1) & mask)
+    {
+        if (m_slots[slot] == account)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void AccountHashSet::Clear()
+{
+    std::fill(m_slots.begin(), m_slots.end(), s_emptySlot);
+    m_size = 0;
+}
+
+size_t AccountHashSet::Size() const
+{
+    return m_size;
+}
+
+size_t AccountHashSet::GetMemoryUsage() const
+{
+    return m_slots.capacity() * sizeof(uint32_t);
+}
+
+size_t AccountHashSet::SlotOf(uint32_t account) const
+{
+    return static_cast<size_t>(Mix(account)) & (m_slots.size() - 1);
+}
+
+void AccountHashSet::Grow()
+{
+    std::vector<uint32_t> slots(m_slots.size() * 2, s_emptySlot);
+    slots.swap(m_slots);
+    m_size = 0;
+    for (uint32_t account : slots)
+    {
+        if (account != s_emptySlot)
+        {
+            Insert(account);
+        }
+    }
+}
+
+AccountBloomFilter::AccountBloomFilter(size_t expectedAccounts)
+{
+    size_t bits = 64;
+    while (bits < expectedAccounts * s_bloomBitsPerAccount)
+    {
+        bits *= 2;
+    }
+    m_bits.assign(bits / 64, 0);
+    m_bitsMask = bits - 1;
+}
+
+void AccountBloomFilter::Add(uint32_t account)
+{
+    const uint64_t hash = Mix(account);
+    const uint64_t step = (hash >> 32) | 1;
+    for (unsigned i = 0; i < s_bloomHashes; ++i)
+    {
+        const uint64_t bit = (hash + i * step) & m_bitsMask;
+        m_bits[bit / 64] |= 1ull << (bit % 64);
+    }
+}
+
+bool AccountBloomFilter::MayContain(uint32_t account) const
+{
+    const uint64_t hash = Mix(account);
+    const uint64_t step = (hash >> 32) | 1;
+    for (unsigned i = 0; i < s_bloomHashes; ++i)
+    {
+        const uint64_t bit = (hash + i * step) & m_bitsMask;
+        if ((m_bits[bit / 64] & (1ull << (bit % 64))) == 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t AccountBloomFilter::GetMemoryUsage() const
+{
+    return m_bits.capacity() * sizeof(uint64_t);
+}
+
+AccountStore::AccountStore(size_t expectedAccounts)
+    : m_blocksSize(0)
+    , m_filter(expectedAccounts)
+{
+}
+
+template<typename Visitor>
+void AccountStore::DecodeBlock(const Block& block, Visitor visit) const
+{
+    const uint8_t* in = m_data.data() + block.offset;
+    uint32_t current = block.first;
+    visit(current);
+    for (uint32_t i = 1; i < block.count; ++i)
+    {
+        current += ReadVarint(in);
+        visit(current);
+    }
+}
+
+bool AccountStore::Add(uint32_t account)
+{
+    if (Contains(account))
+    {
+        return false;
+    }
+
+    m_filter.Add(account);
+    m_pending.Insert(account);
+    if (m_pending.Size() >= std::max(s_minPendingToCompact, m_blocksSize / s_pendingFractionToCompact))
+    {
+        Compact();
+    }
+    return true;
+}
+
+bool AccountStore::Contains(uint32_t account) const
+{
+    return m_filter.MayContain(account) && (m_pending.Contains(account) || ContainsInBlocks(account));
+}
+
+void AccountStore::Compact()
+{
+    if (m_pending.Size() == 0)
+    {
+        return;
+    }
+
+    std::vector<uint32_t> pending;
+    pending.reserve(m_pending.Size());
+    m_pending.ForEach([&](uint32_t account) { pending.push_back(account); });
+    std::sort(pending.begin(), pending.end());
+
+    std::vector<Block> blocks;
+    std::vector<uint8_t> data;
+    data.reserve(m_data.size() + pending.size() * 2);
+    uint32_t previous = 0;
+    auto append = [&](uint32_t account)
+    {
+        if (blocks.empty() || blocks.back().count == s_accountsPerBlock)
+        {
+            blocks.push_back(Block{ account, static_cast<uint32_t>(data.size()), 1 });
+        }
+        else
+        {
+            WriteVarint(account - previous, data);
+            ++blocks.back().count;
+        }
+        previous = account;
+    };
+
+    auto next = pending.begin();
+    for (const Block& block : m_blocks)
+    {
+        DecodeBlock(block, [&](uint32_t account)
+        {
+            for (; next != pending.end() && *next < account; ++next)
+            {
+                append(*next);
+            }
+            append(account);
+        });
+    }
+    for (; next != pending.end(); ++next)
+    {
+        append(*next);
+    }
+
+    m_blocksSize += pending.size();
+    m_blocks.swap(blocks);
+    m_data.swap(data);
+    m_data.shrink_to_fit();
+    m_pending.Clear();
+}
+
+size_t AccountStore::Size() const
+{
+    return m_blocksSize + m_pending.Size();
+}
+
+size_t AccountStore::GetMemoryUsage() const
+{
+    return m_blocks.capacity() * sizeof(Block) + m_data.capacity() +
+            m_pending.GetMemoryUsage() + m_filter.GetMemoryUsage();
+}
+
+void AccountStore::ForEach(const std::function<void(uint32_t account)>& visit)
+{
+    Compact();
+    for (const Block& block : m_blocks)
+    {
+        DecodeBlock(block, visit);
+    }
+}
+
+bool AccountStore::ContainsInBlocks(uint32_t account) const
+{
+    // The last block which starts at or before the account
+    auto block = std::upper_bound(m_blocks.begin(), m_blocks.end(), account,
+                                  [](uint32_t value, const Block& block) { return value < block.first; });
+    if (block == m_blocks.begin())
+    {
+        return false;
+    }
+    --block;
+
+    const uint8_t* in = m_data.data() + block->offset;
+    uint32_t current = block->first;
+    for (uint32_t i = 1; i < block->count && current < account; ++i)
+    {
+        current += ReadVarint(in);
+    }
+    return current == account;
+}
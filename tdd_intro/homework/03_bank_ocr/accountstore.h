@@ -0,0 +1,105 @@
+#pragma once
+#include "ocr.h"
+#include <cstdint>
+#include <functional>
+
+namespace ocr
+{
+    // 9 digits always fit 32 bits. Returns false for an account with illegible digits.
+    bool PackAccount(const char account[g_digitsOnDisplay], uint32_t& packed);
+    std::string UnpackAccount(uint32_t packed);
+}
+
+// Open addressing set of packed accounts with linear probing
+class AccountHashSet
+{
+public:
+    AccountHashSet();
+
+    // Returns false when the account is there already
+    bool Insert(uint32_t account);
+    bool Contains(uint32_t account) const;
+    void Clear();
+
+    size_t Size() const;
+    size_t GetMemoryUsage() const;
+    template<typename Visitor>
+    void ForEach(Visitor visit) const;
+
+private:
+    static const uint32_t s_emptySlot = UINT32_MAX;
+
+    size_t SlotOf(uint32_t account) const;
+    void Grow();
+
+    std::vector<uint32_t> m_slots;
+    size_t m_size;
+};
+
+// Answers "definitely not seen" without touching the store, false positives are possible
+class AccountBloomFilter
+{
+public:
+    explicit AccountBloomFilter(size_t expectedAccounts);
+
+    void Add(uint32_t account);
+    bool MayContain(uint32_t account) const;
+    size_t GetMemoryUsage() const;
+
+private:
+    std::vector<uint64_t> m_bits;
+    uint64_t m_bitsMask;
+};
+
+/*
+ * Set of accounts kept as sorted blocks of varint encoded deltas.
+ * New accounts go to a small hash set first and are merged into the blocks
+ * when it grows past a fraction of the store, so merges stay amortized O(1) per account.
+ * Lookups check the Bloom filter, then the hash set, then decode one block found by binary search.
+ */
+class AccountStore
+{
+public:
+    explicit AccountStore(size_t expectedAccounts = 1 << 20);
+
+    // Returns false if the account was stored before
+    bool Add(uint32_t account);
+    bool Contains(uint32_t account) const;
+    // Merges pending accounts into the blocks
+    void Compact();
+
+    size_t Size() const;
+    size_t GetMemoryUsage() const;
+    // Visits all accounts in ascending order
+    void ForEach(const std::function<void(uint32_t account)>& visit);
+
+private:
+    struct Block
+    {
+        uint32_t first;
+        uint32_t offset;  // of the deltas in m_data
+        uint32_t count;
+    };
+
+    bool ContainsInBlocks(uint32_t account) const;
+    template<typename Visitor>
+    void DecodeBlock(const Block& block, Visitor visit) const;
+
+    std::vector<Block> m_blocks;
+    std::vector<uint8_t> m_data;
+    size_t m_blocksSize;
+    AccountHashSet m_pending;
+    AccountBloomFilter m_filter;
+};
+
+template<typename Visitor>
+void AccountHashSet::ForEach(Visitor visit) const
+{
+    for (uint32_t slot : m_slots)
+    {
+        if (slot != s_emptySlot)
+        {
+            visit(slot);
+        }
+    }
+}
@@ -0,0 +1,148 @@
+// Performance checks for the OCR parser.
+// They are disabled by default, run them with --gtest_also_run_disabled_tests --gtest_filter=*Benchmark*
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include "ocr.h"
+#include "ingest.h"
+#include "glyphkernels.h"
+#include "correction.h"
+#include "accountstore.h"
+
+namespace
+{
+    const size_t s_benchmarkEntries = 1000000;
+
+    std::string MakeSyntheticScan(size_t entriesCount)
+    {
+        const std::string entry = "    _  _     _  _  _  _  _ \n"
+                                  "  | _| _||_||_ |_   ||_||_|\n"
+                                  "  ||_  _|  | _||_|  ||_| _|\n"
+                                  "\n";
+        std::string text;
+        text.reserve(entry.size() * entriesCount);
+        for (size_t i = 0; i < entriesCount; ++i)
+        {
+            text += entry;
+        }
+        return text;
+    }
+
+    template<typename Action>
+    double MeasureSeconds(Action action)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        action();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+TEST(BankOcrBenchmark, DISABLED_ParallelIngestScaling)
+{
+    const std::string text = MakeSyntheticScan(s_benchmarkEntries);
+    const unsigned maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    std::vector<std::string> accounts;
+    const double serial = MeasureSeconds([&]() { accounts = ocr::ParseEntries(text); });
+    ASSERT_EQ(s_benchmarkEntries, accounts.size());
+    std::cout << "serial: " << s_benchmarkEntries / serial << " entries/sec" << std::endl;
+
+    for (unsigned threads = 1; threads <= maxThreads; ++threads)
+    {
+        const double parallel = MeasureSeconds([&]() { accounts = ocr::ParseEntriesParallel(text, threads); });
+        ASSERT_EQ(s_benchmarkEntries, accounts.size());
+        EXPECT_EQ("123456789", accounts.back());
+        std::cout << threads << " threads: " << s_benchmarkEntries / parallel << " entries/sec, speedup "
+                  << serial / parallel << std::endl;
+    }
+}
+
+TEST(BankOcrBenchmark, DISABLED_GlyphKernels)
+{
+    const std::string text = MakeSyntheticScan(1);
+    const char* lines[g_linesInDigit] = { text.data(), text.data() + g_lineLen + 1, text.data() + 2 * (g_lineLen + 1) };
+    const size_t lengths[g_linesInDigit] = { g_lineLen, g_lineLen, g_lineLen };
+
+    const std::pair<ocr::GlyphKernel, const char*> kernels[] = {
+        { ocr::GlyphKernel::Scalar, "scalar" },
+        { ocr::GlyphKernel::Sse2, "sse2" },
+        { ocr::GlyphKernel::Avx2, "avx2" }
+    };
+    for (const auto& kernel : kernels)
+    {
+        if (!ocr::IsGlyphKernelSupported(kernel.first))
+        {
+            std::cout << kernel.second << ": not supported" << std::endl;
+            continue;
+        }
+
+        char account[g_digitsOnDisplay];
+        size_t checksum = 0;
+        const double seconds = MeasureSeconds([&]()
+        {
+            for (size_t i = 0; i < s_benchmarkEntries * 10; ++i)
+            {
+                ocr::DecodeEntry(kernel.first, lines, lengths, account);
+                checksum += account[i % g_digitsOnDisplay];
+            }
+        });
+        EXPECT_NE(0u, checksum);
+        std::cout << kernel.second << ": " << s_benchmarkEntries * 10 / seconds << " entries/sec" << std::endl;
+    }
+}
+
+TEST(BankOcrBenchmark, DISABLED_AmbiguityResolution)
+{
+    // Every digit of 888888888 has neighbours, so all of them are tried
+    const std::string text = " _  _  _  _  _  _  _  _  _ \n"
+                             "|_||_||_||_||_||_||_||_||_|\n"
+                             "|_||_||_||_||_||_||_||_||_|\n";
+    const char* lines[g_linesInDigit] = { text.data(), text.data() + g_lineLen + 1, text.data() + 2 * (g_lineLen + 1) };
+    const size_t lengths[g_linesInDigit] = { g_lineLen, g_lineLen, g_lineLen };
+    GlyphMask glyphs[g_digitsOnDisplay];
+    ocr::ExtractEntryGlyphs(lines, lengths, glyphs);
+
+    size_t candidates = 0;
+    const double seconds = MeasureSeconds([&]()
+    {
+        for (size_t i = 0; i < s_benchmarkEntries; ++i)
+        {
+            candidates += ocr::ResolveAccount(glyphs).candidates.size();
+        }
+    });
+    EXPECT_EQ(3 * s_benchmarkEntries, candidates);
+    std::cout << "resolved: " << s_benchmarkEntries / seconds << " entries/sec" << std::endl;
+}
+
+TEST(BankOcrBenchmark, DISABLED_AccountStore)
+{
+    AccountStore store(s_benchmarkEntries);
+    uint64_t seed = 1;
+    const double insertSeconds = MeasureSeconds([&]()
+    {
+        for (size_t i = 0; i < s_benchmarkEntries; ++i)
+        {
+            seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+            store.Add(static_cast<uint32_t>((seed >> 33) % 1000000000));
+        }
+        store.Compact();
+    });
+
+    size_t found = 0;
+    const double lookupSeconds = MeasureSeconds([&]()
+    {
+        for (size_t i = 0; i < s_benchmarkEntries; ++i)
+        {
+            seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+            found += store.Contains(static_cast<uint32_t>((seed >> 33) % 1000000000));
+        }
+    });
+
+    std::cout << "accounts: " << store.Size() << ", bytes per account: "
+              << static_cast<double>(store.GetMemoryUsage()) / store.Size()
+              << " (std::string: " << sizeof(std::string) << "+)" << std::endl;
+    std::cout << "inserts: " << s_benchmarkEntries / insertSeconds << "/sec, lookups: "
+              << s_benchmarkEntries / lookupSeconds << "/sec, found " << found << std::endl;
+}
@@ -0,0 +1,170 @@
+#include "correction.h"
+#include "font.h"
+#include <algorithm>
+
+namespace
+{
+    struct NeighboursTable
+    {
+        GlyphNeighbours glyphs[g_glyphsCount];
+    };
+
+    constexpr NeighboursTable MakeNeighboursTable(const DigitsLookup& lookup)
+    {
+        NeighboursTable table = {};
+        for (unsigned mask = 0; mask < g_glyphsCount; ++mask)
+        {
+            GlyphNeighbours& neighbours = table.glyphs[mask];
+            for (unsigned short cell = 0; cell < g_glyphBits; ++cell)
+            {
+                const unsigned stroke = 1u << cell;
+                const char digit = lookup.digits[mask ^ stroke];
+                if ((g_strokeCells & stroke) != 0 && digit != ocr::s_illegibleDigit)
+                {
+                    neighbours.digits[neighbours.count++] = digit;
+                }
+            }
+        }
+        return table;
+    }
+
+    constexpr NeighboursTable s_neighbours = MakeNeighboursTable(ocr::s_standardDigits);
+    static_assert(s_neighbours.glyphs[ocr::FontGlyphMask(ocr::s_standardFont, 1)].count == 1,
+                  "1 has to be one stroke away from 7 only");
+
+    unsigned WeightOf(unsigned short position)
+    {
+        return g_digitsOnDisplay - position;
+    }
+
+    unsigned ValueOf(char digit)
+    {
+        return static_cast<unsigned>(digit - '0');
+    }
+
+    void AddCandidate(const std::string& account, unsigned short position, char digit,
+                      std::vector<std::string>& candidates)
+    {
+        candidates.push_back(account);
+        candidates.back()[position] = digit;
+    }
+}
+
+const GlyphNeighbours& ocr::GetGlyphNeighbours(GlyphMask mask)
+{
+    return s_neighbours.glyphs[mask & (g_glyphsCount - 1)];
+}
+
+Resolution ocr::ResolveAccount(const GlyphMask glyphs[g_digitsOnDisplay])
+{
+    Resolution resolution;
+    resolution.account.resize(g_digitsOnDisplay);
+
+    unsigned short illegibleCount = 0;
+    unsigned short illegiblePosition = 0;
+    unsigned sum = 0;
+    for (unsigned short position = 0; position < g_digitsOnDisplay; ++position)
+    {
+        const char digit = GlyphToDigit(glyphs[position]);
+        resolution.account[position] = digit;
+        if (digit == s_illegibleDigit)
+        {
+            ++illegibleCount;
+            illegiblePosition = position;
+        }
+        else
+        {
+            sum += WeightOf(position) * ValueOf(digit);
+        }
+    }
+
+    if (illegibleCount == 0 && sum % g_checksumModulo == 0)
+    {
+        resolution.status = AccountStatus::Valid;
+        return resolution;
+    }
+    resolution.status = illegibleCount == 0 ? AccountStatus::Error : AccountStatus::Illegible;
+
+    std::vector<std::string>& candidates = resolution.candidates;
+    if (illegibleCount == 1)
+    {
+        // sum holds all the other digits already, only the missing term is added
+        const GlyphNeighbours& neighbours = GetGlyphNeighbours(glyphs[illegiblePosition]);
+        for (unsigned short i = 0; i < neighbours.count; ++i)
+        {
+            const unsigned fixed = sum + WeightOf(illegiblePosition) * ValueOf(neighbours.digits[i]);
+            if (fixed % g_checksumModulo == 0)
+            {
+                AddCandidate(resolution.account, illegiblePosition, neighbours.digits[i], candidates);
+            }
+        }
+    }
+    else if (illegibleCount == 0)
+    {
+        // Replacing one digit changes a single term of the sum
+        for (unsigned short position = 0; position < g_digitsOnDisplay; ++position)
+        {
+            const unsigned others = sum - WeightOf(position) * ValueOf(resolution.account[position]);
+            const GlyphNeighbours& neighbours = GetGlyphNeighbours(glyphs[position]);
+            for (unsigned short i = 0; i < neighbours.count; ++i)
+            {
+                if ((others + WeightOf(position) * ValueOf(neighbours.digits[i])) % g_checksumModulo == 0)
+                {
+                    AddCandidate(resolution.account, position, neighbours.digits[i], candidates);
+                }
+            }
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    if (candidates.size() == 1)
+    {
+        resolution.status = AccountStatus::Valid;
+        resolution.account = candidates.front();
+        candidates.clear();
+    }
+    else if (candidates.size() > 1)
+    {
+        resolution.status = AccountStatus::Ambiguous;
+    }
+
+    return resolution;
+}
+
+Resolution ocr::ResolveDisplay(const Display& display)
+{
+    const char* lines[g_linesInDigit];
+    size_t lengths[g_linesInDigit];
+    for (unsigned short row = 0; row < g_linesInDigit; ++row)
+    {
+        lines[row] = display.lines[row].data();
+        lengths[row] = display.lines[row].size();
+    }
+
+    GlyphMask glyphs[g_digitsOnDisplay];
+    ExtractEntryGlyphs(lines, lengths, glyphs);
+    return ResolveAccount(glyphs);
+}
+
+std::string ocr::FormatResolution(const Resolution& resolution)
+{
+    switch (resolution.status)
+    {
+    case AccountStatus::Illegible:
+        return resolution.account + " ILL";
+    case AccountStatus::Error:
+        return resolution.account + " ERR";
+    case AccountStatus::Ambiguous:
+    {
+        std::string text = resolution.account + " AMB [";
+        for (size_t i = 0; i < resolution.candidates.size(); ++i)
+        {
+            text += (i == 0 ? "'" : ", '") + resolution.candidates[i] + "'";
+        }
+        return text + "]";
+    }
+    default:
+        return resolution.account;
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include "validation.h"
+
+/*
+ * An illegible digit or a failed checksum may come from a single missed or extra stroke.
+ * Corrections try every glyph one '_' or '|' away from the scanned one and keep
+ * the account numbers which pass the checksum.
+ */
+
+// Digits which glyphs differ from a glyph by exactly one stroke
+struct GlyphNeighbours
+{
+    unsigned short count;
+    char digits[g_glyphBits];
+};
+
+struct Resolution
+{
+    AccountStatus status;
+    // The scanned account, or the corrected one if a single correction fits
+    std::string account;
+    // Sorted corrections which pass the checksum, only for AccountStatus::Ambiguous
+    std::vector<std::string> candidates;
+};
+
+namespace ocr
+{
+    // Precomputed for the whole glyph space at compile time
+    const GlyphNeighbours& GetGlyphNeighbours(GlyphMask mask);
+
+    // Keeps valid accounts as they are, corrects the rest if possible.
+    // Checksum of each candidate is derived from the one of the scanned account.
+    Resolution ResolveAccount(const GlyphMask glyphs[g_digitsOnDisplay]);
+    Resolution ResolveDisplay(const Display& display);
+
+    // "490067715 AMB ['490067115', '490067719', '490867715']"
+    std::string FormatResolution(const Resolution& resolution);
+}
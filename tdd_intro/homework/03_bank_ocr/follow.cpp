@@ -0,0 +1,207 @@
+#include "follow.h"
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    const size_t s_readBlock = 64 * 1024;
+    // Dozens of entries, a rewritten file hardly starts with all of them the same
+    const size_t s_fingerprintSize = 4096;
+
+#ifdef __linux__
+    // Waits till the file is modified or timeout expires
+    class ChangeWaiter
+    {
+    public:
+        explicit ChangeWaiter(const std::string& path)
+            : m_fd(inotify_init1(IN_NONBLOCK))
+        {
+            if (m_fd >= 0 && inotify_add_watch(m_fd, path.c_str(), IN_MODIFY | IN_CLOSE_WRITE) < 0)
+            {
+                close(m_fd);
+                m_fd = -1;
+            }
+        }
+
+        ~ChangeWaiter()
+        {
+            if (m_fd >= 0)
+            {
+                close(m_fd);
+            }
+        }
+
+        void Wait(std::chrono::milliseconds timeout)
+        {
+            if (m_fd < 0)
+            {
+                std::this_thread::sleep_for(timeout);
+                return;
+            }
+
+            pollfd descriptor = { m_fd, POLLIN, 0 };
+            if (poll(&descriptor, 1, static_cast<int>(timeout.count())) > 0)
+            {
+                char events[4096];
+                while (read(m_fd, events, sizeof(events)) > 0)
+                {
+                }
+            }
+        }
+
+    private:
+        int m_fd;
+    };
+#else
+    class ChangeWaiter
+    {
+    public:
+        explicit ChangeWaiter(const std::string&)
+        {
+        }
+
+        void Wait(std::chrono::milliseconds timeout)
+        {
+            std::this_thread::sleep_for(timeout);
+        }
+    };
+#endif
+}
+
+ScanFollower::ScanFollower(EntryHandler onEntry, size_t decodedOffset)
+    : m_onEntry(onEntry)
+    , m_decodedOffset(decodedOffset)
+    , m_decodedEntries(0)
+    , m_scannedBytes(0)
+    , m_scannedLines(0)
+{
+}
+
+void ScanFollower::Append(const char* data, size_t size)
+{
+    m_pending.append(data, size);
+
+    size_t recordBegin = 0;
+    for (size_t position = m_scannedBytes; position < m_pending.size(); ++position)
+    {
+        const void* lineEnd = std::memchr(m_pending.data() + position, '\n', m_pending.size() - position);
+        if (!lineEnd)
+        {
+            break;
+        }
+        position = static_cast<const char*>(lineEnd) - m_pending.data();
+        if (++m_scannedLines < g_linesInEntry)
+        {
+            continue;
+        }
+
+        ocr::ParseEntries(m_pending.data() + recordBegin, m_pending.data() + position + 1, &m_account);
+        m_decodedOffset += position + 1 - recordBegin;
+        ++m_decodedEntries;
+        m_onEntry(m_account);
+
+        recordBegin = position + 1;
+        m_scannedLines = 0;
+    }
+
+    m_pending.erase(0, recordBegin);
+    m_scannedBytes = m_pending.size();
+}
+
+void ScanFollower::Reset(size_t decodedOffset)
+{
+    m_decodedOffset = decodedOffset;
+    m_pending.clear();
+    m_scannedBytes = 0;
+    m_scannedLines = 0;
+}
+
+size_t ScanFollower::GetDecodedOffset() const
+{
+    return m_decodedOffset;
+}
+
+size_t ScanFollower::GetReadOffset() const
+{
+    return m_decodedOffset + m_pending.size();
+}
+
+size_t ScanFollower::GetDecodedEntries() const
+{
+    return m_decodedEntries;
+}
+
+FileFollower::FileFollower(const std::string& path, ScanFollower& follower)
+    : m_path(path)
+    , m_follower(follower)
+    , m_buffer(s_readBlock)
+    , m_fileId{ 0, 0 }
+{
+}
+
+size_t FileFollower::Poll()
+{
+    std::ifstream file(m_path, std::ios::binary | std::ios::ate);
+    if (!file)
+    {
+        return 0;
+    }
+
+    FileId id = { 0, 0 };
+#ifdef __linux__
+    struct stat status;
+    if (stat(m_path.c_str(), &status) == 0)
+    {
+        id = { static_cast<unsigned long long>(status.st_dev), static_cast<unsigned long long>(status.st_ino) };
+    }
+#endif
+
+    const size_t entriesBefore = m_follower.GetDecodedEntries();
+    const size_t size = static_cast<size_t>(file.tellg());
+    if (!IsSameFile(file, size, id))
+    {
+        // The file was truncated or replaced, its content is new
+        m_follower.Reset();
+    }
+
+    file.seekg(static_cast<std::streamoff>(m_follower.GetReadOffset()));
+    while (file.read(m_buffer.data(), m_buffer.size()) || file.gcount() > 0)
+    {
+        m_follower.Append(m_buffer.data(), static_cast<size_t>(file.gcount()));
+    }
+
+    return m_follower.GetDecodedEntries() - entriesBefore;
+}
+
+bool FileFollower::IsSameFile(std::ifstream& file, size_t size, const FileId& id)
+{
+    // Nothing is known of a file followed from an offset until the first poll
+    const bool sameId = m_fileId.inode == 0 || (m_fileId.device == id.device && m_fileId.inode == id.inode);
+    m_fileId = id;
+
+    std::string fingerprint(std::min(size, s_fingerprintSize), '\0');
+    file.seekg(0);
+    file.read(&fingerprint[0], static_cast<std::streamsize>(fingerprint.size()));
+    const bool sameStart = fingerprint.compare(0, m_fingerprint.size(), m_fingerprint) == 0;
+    m_fingerprint = fingerprint;
+
+    return sameId && sameStart && size >= m_follower.GetReadOffset();
+}
+
+void FileFollower::Follow(const std::atomic<bool>& stop, std::chrono::milliseconds interval)
+{
+    ChangeWaiter waiter(m_path);
+    while (!stop)
+    {
+        Poll();
+        waiter.Wait(interval);
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include "ocr.h"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <functional>
+
+/*
+ * Decodes a scan file while the scanner is still writing it.
+ * A record counts as complete only when its separator line is terminated,
+ * so a partially written entry is kept aside until the rest of it arrives.
+ */
+class ScanFollower
+{
+public:
+    typedef std::function<void(const std::string& account)> EntryHandler;
+
+    // decodedOffset - file offset right after the last record decoded before, to resume from
+    explicit ScanFollower(EntryHandler onEntry, size_t decodedOffset = 0);
+
+    // Takes bytes appended to the file and emits every record they complete
+    void Append(const char* data, size_t size);
+    // Drops the incomplete record and starts over from the given offset, e.g. after the file was rotated
+    void Reset(size_t decodedOffset = 0);
+
+    // File offset right after the last fully decoded record
+    size_t GetDecodedOffset() const;
+    // File offset of the next byte expected by Append
+    size_t GetReadOffset() const;
+    size_t GetDecodedEntries() const;
+
+private:
+    EntryHandler m_onEntry;
+    size_t m_decodedOffset;
+    size_t m_decodedEntries;
+    // Bytes of the record which is not complete yet
+    std::string m_pending;
+    // Part of m_pending already searched for line breaks and how many were found there
+    size_t m_scannedBytes;
+    unsigned short m_scannedLines;
+    std::string m_account;
+};
+
+/*
+ * Feeds ScanFollower from a file on disk.
+ * On Linux it sleeps on inotify between polls, elsewhere it just polls with the given interval.
+ * A file which was replaced, or truncated and written again, is read anew from its start:
+ * it is told by another inode, a size below the read offset, or another beginning of the file.
+ */
+class FileFollower
+{
+public:
+    FileFollower(const std::string& path, ScanFollower& follower);
+
+    // Reads whatever was appended since the last call, returns number of new entries
+    size_t Poll();
+    // Polls until stop is set
+    void Follow(const std::atomic<bool>& stop, std::chrono::milliseconds interval);
+
+private:
+    // Zeros where the system doesn't tell
+    struct FileId
+    {
+        unsigned long long device;
+        unsigned long long inode;
+    };
+
+    bool IsSameFile(std::ifstream& file, size_t size, const FileId& id);
+
+    std::string m_path;
+    ScanFollower& m_follower;
+    std::vector<char> m_buffer;
+    FileId m_fileId;
+    // First bytes of the file read so far
+    std::string m_fingerprint;
+};
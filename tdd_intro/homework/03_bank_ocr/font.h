@@ -0,0 +1,129 @@
+#pragma once
+#include "ocr.h"
+
+/*
+ * Fonts of scanner models, checked and turned into lookup tables by the compiler.
+ * To support another scanner, describe its glyphs as a Font, check it with IsFontValid
+ * in a static_assert and build its table with MakeDigitsLookup into a constexpr variable.
+ */
+
+const unsigned short g_digitsInFont = 10;
+
+struct Font
+{
+    // Glyph of each digit, row by row
+    const char* glyphs[g_digitsInFont][g_linesInDigit];
+};
+
+// Digit for every possible glyph mask
+struct DigitsLookup
+{
+    char digits[g_glyphsCount];
+};
+
+namespace ocr
+{
+    // Stroke expected in the cell, ' ' for cells which are always blank
+    constexpr char StrokeAt(unsigned short row, unsigned short column)
+    {
+        return row == 0 ? (column == 1 ? '_' : ' ') : (column == 1 ? '_' : '|');
+    }
+
+    constexpr GlyphMask FontGlyphMask(const Font& font, unsigned short digit)
+    {
+        GlyphMask mask = 0;
+        for (unsigned short row = 0; row < g_linesInDigit; ++row)
+        {
+            for (unsigned short column = 0; column < g_digitLen; ++column)
+            {
+                const char stroke = StrokeAt(row, column);
+                if (stroke != ' ' && font.glyphs[digit][row][column] == stroke)
+                {
+                    mask |= 1 << (row * g_digitLen + column);
+                }
+            }
+        }
+        return mask;
+    }
+
+    // Every row is g_digitLen long and has either a space or the expected stroke in each cell
+    constexpr bool IsGlyphWellFormed(const Font& font, unsigned short digit)
+    {
+        for (unsigned short row = 0; row < g_linesInDigit; ++row)
+        {
+            const char* line = font.glyphs[digit][row];
+            for (unsigned short column = 0; column < g_digitLen; ++column)
+            {
+                if (line[column] == '\0' || (line[column] != ' ' && line[column] != StrokeAt(row, column)))
+                {
+                    return false;
+                }
+            }
+            if (line[g_digitLen] != '\0')
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    constexpr bool HasCollisions(const Font& font)
+    {
+        for (unsigned short digit = 0; digit < g_digitsInFont; ++digit)
+        {
+            for (unsigned short other = digit + 1; other < g_digitsInFont; ++other)
+            {
+                if (FontGlyphMask(font, digit) == FontGlyphMask(font, other))
+                {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    constexpr bool IsFontValid(const Font& font)
+    {
+        for (unsigned short digit = 0; digit < g_digitsInFont; ++digit)
+        {
+            if (!IsGlyphWellFormed(font, digit))
+            {
+                return false;
+            }
+        }
+        return !HasCollisions(font);
+    }
+
+    constexpr DigitsLookup MakeDigitsLookup(const Font& font)
+    {
+        DigitsLookup lookup = {};
+        for (unsigned mask = 0; mask < g_glyphsCount; ++mask)
+        {
+            lookup.digits[mask] = s_illegibleDigit;
+        }
+        for (unsigned short digit = 0; digit < g_digitsInFont; ++digit)
+        {
+            lookup.digits[FontGlyphMask(font, digit)] = static_cast<char>('0' + digit);
+        }
+        return lookup;
+    }
+
+    constexpr Font s_standardFont = { {
+        { " _ ", "| |", "|_|" },
+        { "   ", "  |", "  |" },
+        { " _ ", " _|", "|_ " },
+        { " _ ", " _|", " _|" },
+        { "   ", "|_|", "  |" },
+        { " _ ", "|_ ", " _|" },
+        { " _ ", "|_ ", "|_|" },
+        { " _ ", "  |", "  |" },
+        { " _ ", "|_|", "|_|" },
+        { " _ ", "|_|", " _|" }
+    } };
+    static_assert(IsFontValid(s_standardFont), "standard font has malformed or colliding glyphs");
+
+    constexpr DigitsLookup s_standardDigits = MakeDigitsLookup(s_standardFont);
+
+    // Decodes with the table of another font
+    std::string ParseDisplay(const Display& display, const DigitsLookup& digits);
+}
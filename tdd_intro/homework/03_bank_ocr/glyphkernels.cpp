@@ -0,0 +1,164 @@
+#include "glyphkernels.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OCR_HAS_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(OCR_HAS_SSE2) && defined(__GNUC__)
+#define OCR_HAS_AVX2
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    // Bit per column of a line where '_' or '|' is expected: "_" at 1, 4, 7... and "|" at 0, 2, 3, 5...
+    const uint32_t s_underscoreColumns = 0x2492492;
+    const uint32_t s_pipeColumns = 0x5B6DB6D;
+
+    // Lit cells of the lines as 27-bit masks, one bit per column
+    struct LitColumns
+    {
+        uint32_t lines[g_linesInDigit];
+    };
+
+    void GatherGlyphs(const LitColumns& lit, GlyphMask glyphs[g_digitsOnDisplay])
+    {
+        for (unsigned short position = 0; position < g_digitsOnDisplay; ++position)
+        {
+            const unsigned shift = position * g_digitLen;
+            glyphs[position] = static_cast<GlyphMask>(((lit.lines[0] >> shift) & 7) |
+                                                      ((lit.lines[1] >> shift) & 7) << g_digitLen |
+                                                      ((lit.lines[2] >> shift) & 7) << (2 * g_digitLen));
+        }
+    }
+
+    LitColumns ClassifyScalar(const char* const lines[g_linesInDigit])
+    {
+        LitColumns lit = { { 0, 0, 0 } };
+        for (unsigned short row = 0; row < g_linesInDigit; ++row)
+        {
+            uint32_t underscores = 0;
+            uint32_t pipes = 0;
+            for (unsigned short column = 0; column < g_lineLen; ++column)
+            {
+                underscores |= static_cast<uint32_t>(lines[row][column] == '_') << column;
+                pipes |= static_cast<uint32_t>(lines[row][column] == '|') << column;
+            }
+            lit.lines[row] = underscores & s_underscoreColumns;
+            if (row != 0)
+            {
+                lit.lines[row] |= pipes & s_pipeColumns;
+            }
+        }
+        return lit;
+    }
+
+#ifdef OCR_HAS_SSE2
+    // Offset of the second load, so that [0, 16) and [11, 27) cover the line without reading past it
+    const unsigned s_highHalfOffset = g_lineLen - 16;
+
+    uint32_t MatchSse2(const char* line, char symbol)
+    {
+        const __m128i pattern = _mm_set1_epi8(symbol);
+        const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(line));
+        const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(line + s_highHalfOffset));
+        const uint32_t lowBits = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(low, pattern)));
+        const uint32_t highBits = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(high, pattern)));
+        return lowBits | highBits << s_highHalfOffset;
+    }
+
+    LitColumns ClassifySse2(const char* const lines[g_linesInDigit])
+    {
+        LitColumns lit;
+        lit.lines[0] = MatchSse2(lines[0], '_') & s_underscoreColumns;
+        for (unsigned short row = 1; row < g_linesInDigit; ++row)
+        {
+            lit.lines[row] = (MatchSse2(lines[row], '_') & s_underscoreColumns) |
+                             (MatchSse2(lines[row], '|') & s_pipeColumns);
+        }
+        return lit;
+    }
+#endif
+
+#ifdef OCR_HAS_AVX2
+    __attribute__((target("avx2")))
+    LitColumns ClassifyAvx2(const char* const lines[g_linesInDigit])
+    {
+        const __m256i underscore = _mm256_set1_epi8('_');
+        const __m256i pipe = _mm256_set1_epi8('|');
+
+        // Lower 128 bits hold line 1, upper ones line 2
+        const __m256i low = _mm256_inserti128_si256(
+                    _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lines[1]))),
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(lines[2])), 1);
+        const __m256i high = _mm256_inserti128_si256(
+                    _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lines[1] + s_highHalfOffset))),
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(lines[2] + s_highHalfOffset)), 1);
+
+        const uint32_t lowUnderscores = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, underscore)));
+        const uint32_t highUnderscores = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, underscore)));
+        const uint32_t lowPipes = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, pipe)));
+        const uint32_t highPipes = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, pipe)));
+
+        LitColumns lit;
+        lit.lines[0] = MatchSse2(lines[0], '_') & s_underscoreColumns;
+        for (unsigned short row = 1; row < g_linesInDigit; ++row)
+        {
+            const unsigned half = (row - 1) * 16;
+            const uint32_t underscores = (lowUnderscores >> half & 0xFFFF) | (highUnderscores >> half & 0xFFFF) << s_highHalfOffset;
+            const uint32_t pipes = (lowPipes >> half & 0xFFFF) | (highPipes >> half & 0xFFFF) << s_highHalfOffset;
+            lit.lines[row] = (underscores & s_underscoreColumns) | (pipes & s_pipeColumns);
+        }
+        return lit;
+    }
+#endif
+}
+
+bool ocr::IsGlyphKernelSupported(GlyphKernel kernel)
+{
+    switch (kernel)
+    {
+    case GlyphKernel::Scalar:
+        return true;
+#ifdef OCR_HAS_SSE2
+    case GlyphKernel::Sse2:
+        return true;
+#endif
+#ifdef OCR_HAS_AVX2
+    case GlyphKernel::Avx2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+ocr::GlyphKernel ocr::GetBestGlyphKernel()
+{
+    static const GlyphKernel s_best = IsGlyphKernelSupported(GlyphKernel::Avx2) ? GlyphKernel::Avx2 :
+                                      IsGlyphKernelSupported(GlyphKernel::Sse2) ? GlyphKernel::Sse2 :
+                                                                                  GlyphKernel::Scalar;
+    return s_best;
+}
+
+void ocr::ExtractGlyphs(GlyphKernel kernel, const char* const lines[g_linesInDigit], GlyphMask glyphs[g_digitsOnDisplay])
+{
+    switch (kernel)
+    {
+#ifdef OCR_HAS_AVX2
+    case GlyphKernel::Avx2:
+        GatherGlyphs(ClassifyAvx2(lines), glyphs);
+        break;
+#endif
+#ifdef OCR_HAS_SSE2
+    case GlyphKernel::Sse2:
+        GatherGlyphs(ClassifySse2(lines), glyphs);
+        break;
+#endif
+    default:
+        GatherGlyphs(ClassifyScalar(lines), glyphs);
+        break;
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "ocr.h"
+#include <cstdint>
+
+namespace ocr
+{
+    /*
+     * Ways to turn 3 lines of an entry into glyph masks:
+     *  Scalar - checks characters one by one, works everywhere
+     *  Sse2   - classifies each line with two overlapping 16-byte compares
+     *  Avx2   - same, but the two lower lines (they share the '|_|' pattern) go through one 32-byte compare
+     */
+    enum class GlyphKernel
+    {
+        Scalar,
+        Sse2,
+        Avx2
+    };
+
+    bool IsGlyphKernelSupported(GlyphKernel kernel);
+    // The fastest kernel the current CPU runs, detected once
+    GlyphKernel GetBestGlyphKernel();
+
+    // Fills masks of the nine glyphs of the entry. Each line must have at least g_lineLen characters.
+    void ExtractGlyphs(GlyphKernel kernel, const char* const lines[g_linesInDigit], GlyphMask glyphs[g_digitsOnDisplay]);
+}
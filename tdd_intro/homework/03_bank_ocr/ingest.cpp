@@ -0,0 +1,104 @@
+#include "ingest.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace
+{
+    // Pieces per worker, so that a slow chunk doesn't leave others idle
+    const size_t s_chunksPerThread = 4;
+
+    template<typename Task>
+    void RunOnWorkers(unsigned threadsCount, size_t tasksCount, Task task)
+    {
+        std::atomic<size_t> nextTask(0);
+        auto worker = [&]()
+        {
+            for (size_t index = nextTask++; index < tasksCount; index = nextTask++)
+            {
+                task(index);
+            }
+        };
+
+        const size_t workersCount = std::min<size_t>(std::max(threadsCount, 1u), tasksCount);
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < workersCount; ++i)
+        {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+    }
+}
+
+std::vector<ocr::Chunk> ocr::FindChunks(const std::string& text, size_t chunksCount, unsigned threadsCount,
+                                        size_t& linesCount)
+{
+    const char* begin = text.data();
+    const size_t size = text.size();
+    chunksCount = std::max<size_t>(std::min(chunksCount, size), 1);
+
+    std::vector<size_t> newlines(chunksCount + 1, 0);
+    RunOnWorkers(threadsCount, chunksCount, [&](size_t index)
+    {
+        newlines[index + 1] = std::count(begin + size * index / chunksCount,
+                                         begin + size * (index + 1) / chunksCount, '\n');
+    });
+
+    std::vector<Chunk> chunks;
+    size_t linesBefore = 0;
+    for (size_t index = 0; index < chunksCount; ++index)
+    {
+        linesBefore += newlines[index];
+        size_t offset = size * index / chunksCount;
+        size_t line = linesBefore;
+
+        // Move to the start of the next line, unless already there
+        if (offset != 0 && begin[offset - 1] != '\n')
+        {
+            const size_t lineEnd = text.find('\n', offset);
+            offset = lineEnd == std::string::npos ? size : lineEnd + 1;
+            ++line;
+        }
+        // Then skip lines till the first line of a record
+        while (offset < size && line % g_linesInEntry != 0)
+        {
+            const size_t lineEnd = text.find('\n', offset);
+            offset = lineEnd == std::string::npos ? size : lineEnd + 1;
+            ++line;
+        }
+
+        if (index == 0 || (offset < size && offset > chunks.back().offset))
+        {
+            chunks.push_back(Chunk{ offset, line / g_linesInEntry });
+        }
+    }
+
+    linesCount = linesBefore + newlines[chunksCount];
+    if (size != 0 && begin[size - 1] != '\n')
+    {
+        ++linesCount;
+    }
+    return chunks;
+}
+
+std::vector<std::string> ocr::ParseEntriesParallel(const std::string& text, unsigned threadsCount)
+{
+    size_t linesCount = 0;
+    const std::vector<Chunk> chunks = FindChunks(text, threadsCount * s_chunksPerThread, threadsCount, linesCount);
+
+    const char* begin = text.data();
+    const char* end = begin + text.size();
+    std::vector<std::string> accounts(EntriesInLines(linesCount));
+
+    RunOnWorkers(threadsCount, chunks.size(), [&](size_t index)
+    {
+        const char* chunkEnd = index + 1 < chunks.size() ? begin + chunks[index + 1].offset : end;
+        ParseEntries(begin + chunks[index].offset, chunkEnd, accounts.data() + chunks[index].firstEntry);
+    });
+
+    return accounts;
+}
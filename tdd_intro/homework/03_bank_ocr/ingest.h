@@ -0,0 +1,26 @@
+#pragma once
+#include "ocr.h"
+
+namespace ocr
+{
+    // Record aligned piece of the scan file
+    struct Chunk
+    {
+        size_t offset;      // byte offset of the first line of the first record in chunk
+        size_t firstEntry;  // index of the first record in chunk
+    };
+
+    /*
+     * Splits text into at most chunksCount pieces, each starting at a record boundary.
+     * Line counts of the byte ranges are taken in parallel, so boundaries stay exact
+     * no matter what the glyph lines contain (a top row of 1s and 4s is blank as well).
+     * The first chunk always starts at 0, empty chunks are dropped.
+     * Number of lines in the whole text is returned through linesCount.
+     */
+    std::vector<Chunk> FindChunks(const std::string& text, size_t chunksCount, unsigned threadsCount,
+                                  size_t& linesCount);
+
+    // Same as ParseEntries, but chunks of text are decoded on threadsCount workers.
+    // Accounts are returned in the order of entries in the file.
+    std::vector<std::string> ParseEntriesParallel(const std::string& text, unsigned threadsCount);
+}
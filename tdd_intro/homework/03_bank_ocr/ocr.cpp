@@ -0,0 +1,182 @@
+#include "ocr.h"
+#include "glyphkernels.h"
+#include "font.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    GlyphMask GetCellsMask(const char* line, size_t length, unsigned short row)
+    {
+        GlyphMask mask = 0;
+        for (unsigned short column = 0; column < g_digitLen && column < length; ++column)
+        {
+            const char stroke = ocr::StrokeAt(row, column);
+            if (stroke != ' ' && line[column] == stroke)
+            {
+                mask |= 1 << (row * g_digitLen + column);
+            }
+        }
+        return mask;
+    }
+
+    const ocr::GlyphKernel s_glyphKernel = ocr::GetBestGlyphKernel();
+
+    const char* FindLineEnd(const char* begin, const char* end)
+    {
+        const void* found = std::memchr(begin, '\n', end - begin);
+        return found ? static_cast<const char*>(found) : end;
+    }
+
+    size_t TrimCarriageReturn(const char* begin, const char* lineEnd)
+    {
+        return lineEnd != begin && *(lineEnd - 1) == '\r' ? lineEnd - begin - 1 : lineEnd - begin;
+    }
+}
+
+GlyphMask ocr::GetGlyphMask(const Digit& digit)
+{
+    GlyphMask mask = 0;
+    for (unsigned short row = 0; row < g_linesInDigit; ++row)
+    {
+        mask |= GetCellsMask(digit.lines[row].data(), digit.lines[row].size(), row);
+    }
+    return mask;
+}
+
+char ocr::GlyphToDigit(GlyphMask mask)
+{
+    return mask < g_glyphsCount ? s_standardDigits.digits[mask] : s_illegibleDigit;
+}
+
+char ocr::ParseDigit(const Digit& digit)
+{
+    return GlyphToDigit(GetGlyphMask(digit));
+}
+
+std::string ocr::ParseDisplay(const Display& display)
+{
+    return ParseDisplay(display, s_standardDigits);
+}
+
+std::string ocr::ParseDisplay(const Display& display, const DigitsLookup& digits)
+{
+    const char* lines[g_linesInDigit];
+    size_t lengths[g_linesInDigit];
+    for (unsigned short row = 0; row < g_linesInDigit; ++row)
+    {
+        lines[row] = display.lines[row].data();
+        lengths[row] = display.lines[row].size();
+    }
+
+    GlyphMask glyphs[g_digitsOnDisplay];
+    ExtractEntryGlyphs(lines, lengths, glyphs);
+
+    std::string account(g_digitsOnDisplay, s_illegibleDigit);
+    for (unsigned short position = 0; position < g_digitsOnDisplay; ++position)
+    {
+        account[position] = digits.digits[glyphs[position]];
+    }
+    return account;
+}
+
+void ocr::DecodeEntry(const char* const lines[g_linesInDigit],
+                      const size_t lengths[g_linesInDigit],
+                      char account[g_digitsOnDisplay])
+{
+    DecodeEntry(s_glyphKernel, lines, lengths, account);
+}
+
+void ocr::DecodeEntry(GlyphKernel kernel,
+                      const char* const lines[g_linesInDigit],
+                      const size_t lengths[g_linesInDigit],
+                      char account[g_digitsOnDisplay])
+{
+    GlyphMask glyphs[g_digitsOnDisplay];
+    ExtractEntryGlyphs(kernel, lines, lengths, glyphs);
+    for (unsigned short position = 0; position < g_digitsOnDisplay; ++position)
+    {
+        account[position] = s_standardDigits.digits[glyphs[position]];
+    }
+}
+
+void ocr::ExtractEntryGlyphs(const char* const lines[g_linesInDigit],
+                             const size_t lengths[g_linesInDigit],
+                             GlyphMask glyphs[g_digitsOnDisplay])
+{
+    ExtractEntryGlyphs(s_glyphKernel, lines, lengths, glyphs);
+}
+
+void ocr::ExtractEntryGlyphs(GlyphKernel kernel,
+                             const char* const lines[g_linesInDigit],
+                             const size_t lengths[g_linesInDigit],
+                             GlyphMask glyphs[g_digitsOnDisplay])
+{
+    // Kernels read whole g_lineLen characters, so short lines go through a space padded copy
+    char padded[g_linesInDigit][g_lineLen];
+    const char* fullLines[g_linesInDigit];
+    for (unsigned short row = 0; row < g_linesInDigit; ++row)
+    {
+        fullLines[row] = lines[row];
+        if (lengths[row] < g_lineLen)
+        {
+            std::fill(std::copy(lines[row], lines[row] + lengths[row], padded[row]), padded[row] + g_lineLen, ' ');
+            fullLines[row] = padded[row];
+        }
+    }
+
+    ExtractGlyphs(kernel, fullLines, glyphs);
+}
+
+size_t ocr::ParseEntries(const char* begin, const char* end, std::string* accounts)
+{
+    size_t entriesCount = 0;
+    const char* lines[g_linesInDigit];
+    size_t lengths[g_linesInDigit];
+    unsigned short row = 0;
+
+    for (const char* line = begin; line < end; )
+    {
+        const char* lineEnd = FindLineEnd(line, end);
+        if (row < g_linesInDigit)
+        {
+            lines[row] = line;
+            lengths[row] = TrimCarriageReturn(line, lineEnd);
+        }
+        if (++row == g_linesInDigit)
+        {
+            std::string& account = accounts[entriesCount++];
+            account.assign(g_digitsOnDisplay, s_illegibleDigit);
+            DecodeEntry(lines, lengths, &account[0]);
+        }
+        row %= g_linesInEntry;
+        line = lineEnd == end ? end : lineEnd + 1;
+    }
+
+    return entriesCount;
+}
+
+std::vector<std::string> ocr::ParseEntries(const std::string& text)
+{
+    const char* begin = text.data();
+    const char* end = begin + text.size();
+
+    std::vector<std::string> accounts(EntriesInLines(CountLines(begin, end)));
+    ParseEntries(begin, end, accounts.data());
+    return accounts;
+}
+
+size_t ocr::EntriesInLines(size_t linesCount)
+{
+    return linesCount / g_linesInEntry + (linesCount % g_linesInEntry >= g_linesInDigit ? 1 : 0);
+}
+
+size_t ocr::CountLines(const char* begin, const char* end)
+{
+    if (begin == end)
+    {
+        return 0;
+    }
+    const size_t newlines = static_cast<size_t>(std::count(begin, end, '\n'));
+    return *(end - 1) == '\n' ? newlines : newlines + 1;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstddef>
+
+const unsigned short g_digitLen = 3;
+const unsigned short g_linesInDigit = 3;
+struct Digit
+{
+    std::string lines[g_linesInDigit];
+};
+
+const unsigned short g_digitsOnDisplay = 9;
+struct Display
+{
+    std::string lines[g_linesInDigit];
+};
+
+// Each entry in the scan file is 3 glyph lines followed by a blank separator line
+const unsigned short g_linesInEntry = g_linesInDigit + 1;
+const unsigned short g_lineLen = g_digitLen * g_digitsOnDisplay;
+
+/*
+ * Every glyph is 3x3 cells. A cell is "lit" when it holds the stroke expected at its position
+ * (' _ ' in the top row, '|_|' in the others), so a glyph is a 9-bit mask, top-left cell first.
+ * Anything else in a cell (space, garbage) leaves it unlit. Top corners are never lit.
+ */
+typedef unsigned short GlyphMask;
+const unsigned short g_glyphBits = g_digitLen * g_linesInDigit;
+const unsigned short g_glyphsCount = 1 << g_glyphBits;
+// Cells which may hold a stroke, i.e. all but the top corners
+const GlyphMask g_strokeCells = 0x1FA;
+
+namespace ocr
+{
+    enum class GlyphKernel;
+
+    // Placed instead of a digit which glyph is not recognized
+    const char s_illegibleDigit = '?';
+
+    GlyphMask GetGlyphMask(const Digit& digit);
+    // Returns '0'..'9' or s_illegibleDigit
+    char GlyphToDigit(GlyphMask mask);
+
+    char ParseDigit(const Digit& digit);
+    std::string ParseDisplay(const Display& display);
+
+    // Decodes one entry given its 3 glyph lines; lines shorter than g_lineLen are padded with spaces
+    void DecodeEntry(const char* const lines[g_linesInDigit],
+                     const size_t lengths[g_linesInDigit],
+                     char account[g_digitsOnDisplay]);
+    // Same, with the given glyph extraction kernel instead of the best supported one
+    void DecodeEntry(GlyphKernel kernel,
+                     const char* const lines[g_linesInDigit],
+                     const size_t lengths[g_linesInDigit],
+                     char account[g_digitsOnDisplay]);
+
+    // Glyph masks of an entry, before they are looked up as digits
+    void ExtractEntryGlyphs(const char* const lines[g_linesInDigit],
+                            const size_t lengths[g_linesInDigit],
+                            GlyphMask glyphs[g_digitsOnDisplay]);
+    void ExtractEntryGlyphs(GlyphKernel kernel,
+                            const char* const lines[g_linesInDigit],
+                            const size_t lengths[g_linesInDigit],
+                            GlyphMask glyphs[g_digitsOnDisplay]);
+
+    // Decodes all entries of [begin, end) which must start at a record boundary.
+    // A trailing record is decoded once all its glyph lines are present.
+    // Decoded accounts are written one by one starting from 'accounts', returns number of entries.
+    size_t ParseEntries(const char* begin, const char* end, std::string* accounts);
+    std::vector<std::string> ParseEntries(const std::string& text);
+
+    // Number of entries ParseEntries produces out of the given number of lines
+    size_t EntriesInLines(size_t linesCount);
+    size_t CountLines(const char* begin, const char* end);
+}
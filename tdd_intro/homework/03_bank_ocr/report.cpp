@@ -0,0 +1,54 @@
+#include "report.h"
+#include <algorithm>
+
+namespace
+{
+    const char* s_statusSuffixes[] = { "", " ILL", " ERR", " AMB" };
+    const size_t s_statusSuffixLengths[] = { 0, 4, 4, 4 };
+    // Account, the longest suffix and a line break
+    const size_t s_maxLineLen = g_digitsOnDisplay + 4 + 1;
+}
+
+StatusReportWriter::StatusReportWriter(std::ostream& output)
+    : m_output(output)
+{
+}
+
+void StatusReportWriter::Write(const ocr::AccountColumns& accounts, const AccountStatus* statuses)
+{
+    if (m_buffer.size() < accounts.count * s_maxLineLen)
+    {
+        m_buffer.resize(accounts.count * s_maxLineLen);
+    }
+
+    char* out = m_buffer.data();
+    for (size_t index = 0; index < accounts.count; ++index)
+    {
+        for (unsigned short position = 0; position < g_digitsOnDisplay; ++position)
+        {
+            *out++ = accounts.Column(position)[index];
+        }
+        const size_t status = static_cast<size_t>(statuses[index]);
+        for (size_t i = 0; i < s_statusSuffixLengths[status]; ++i)
+        {
+            *out++ = s_statusSuffixes[status][i];
+        }
+        *out++ = '\n';
+    }
+
+    m_output.write(m_buffer.data(), out - m_buffer.data());
+}
+
+void ocr::WriteStatusReport(const std::vector<std::string>& accounts, std::ostream& output)
+{
+    StatusReportWriter writer(output);
+    AccountColumns columns;
+    std::vector<AccountStatus> statuses(std::min(accounts.size(), g_reportBatch));
+
+    for (size_t first = 0; first < accounts.size(); first += g_reportBatch)
+    {
+        PackAccounts(accounts.data() + first, std::min(accounts.size() - first, g_reportBatch), columns);
+        ValidateAccounts(columns, statuses.data());
+        writer.Write(columns, statuses.data());
+    }
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include "validation.h"
+#include <ostream>
+
+/*
+ * Writes the status report, one line per account:
+ * 457508000
+ * 664371495 ERR
+ * 86110??36 ILL
+ */
+class StatusReportWriter
+{
+public:
+    explicit StatusReportWriter(std::ostream& output);
+
+    // Formats the whole batch in the internal buffer and passes it to the stream at once.
+    // The buffer is kept between batches, so it allocates only when a batch is the biggest so far.
+    void Write(const ocr::AccountColumns& accounts, const AccountStatus* statuses);
+
+private:
+    std::ostream& m_output;
+    std::vector<char> m_buffer;
+};
+
+namespace ocr
+{
+    // Accounts validated and written at once by WriteStatusReport
+    const size_t g_reportBatch = 4096;
+
+    // Validates accounts in batches and writes the report for them
+    void WriteStatusReport(const std::vector<std::string>& accounts, std::ostream& output);
+}
@@ -86,19 +86,19 @@ Example input and output
 */
 #include <gtest/gtest.h>
 #include <string>
-
-const unsigned short g_digitLen = 3;
-const unsigned short g_linesInDigit = 3;
-struct Digit
-{
-    std::string lines[g_linesInDigit];
-};
-
-const unsigned short g_digitsOnDisplay = 9;
-struct Display
-{
-    std::string lines[g_linesInDigit];
-};
+#include "ocr.h"
+#include "ingest.h"
+#include "glyphkernels.h"
+#include "report.h"
+#include "correction.h"
+#include "font.h"
+#include "follow.h"
+#include "accountstore.h"
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <algorithm>
+#include <sstream>
 
 const Digit s_digit0 = { " _ ",
                          "| |",
@@ -195,3 +195,663 @@ const Display s_display123456789 = { "    _  _     _  _  _  _  _ ",
                                      "  | _| _||_||_ |_   ||_||_|",
                                      "  ||_  _|  | _||_|  ||_| _|"
 };
+
+namespace
+{
+    std::string FormatEntry(const Display& display)
+    {
+        return display.lines[0] + "\n" + display.lines[1] + "\n" + display.lines[2] + "\n\n";
+    }
+
+    std::string MakeScanFile(size_t entriesCount)
+    {
+        const Display* displays[] = { &s_displayAll0, &s_displayAll1, &s_displayAll4, &s_display123456789 };
+        std::string text;
+        for (size_t i = 0; i < entriesCount; ++i)
+        {
+            text += FormatEntry(*displays[i % 4]);
+        }
+        return text;
+    }
+}
+
+TEST(BankOcr, ParseDigits)
+{
+    EXPECT_EQ('0', ocr::ParseDigit(s_digit0));
+    EXPECT_EQ('1', ocr::ParseDigit(s_digit1));
+    EXPECT_EQ('2', ocr::ParseDigit(s_digit2));
+    EXPECT_EQ('3', ocr::ParseDigit(s_digit3));
+    EXPECT_EQ('4', ocr::ParseDigit(s_digit4));
+    EXPECT_EQ('5', ocr::ParseDigit(s_digit5));
+    EXPECT_EQ('6', ocr::ParseDigit(s_digit6));
+    EXPECT_EQ('7', ocr::ParseDigit(s_digit7));
+    EXPECT_EQ('8', ocr::ParseDigit(s_digit8));
+    EXPECT_EQ('9', ocr::ParseDigit(s_digit9));
+}
+
+TEST(BankOcr, ParseUnknownDigit)
+{
+    const Digit digit = { " _ ", "| |", "| |" };
+    EXPECT_EQ(ocr::s_illegibleDigit, ocr::ParseDigit(digit));
+}
+
+TEST(BankOcr, ParseDigitWithWrongStroke)
+{
+    const Digit digit = { " | ", "| |", "|_|" };
+    EXPECT_EQ(ocr::s_illegibleDigit, ocr::ParseDigit(digit));
+}
+
+TEST(BankOcr, ParseDisplays)
+{
+    EXPECT_EQ("000000000", ocr::ParseDisplay(s_displayAll0));
+    EXPECT_EQ("111111111", ocr::ParseDisplay(s_displayAll1));
+    EXPECT_EQ("222222222", ocr::ParseDisplay(s_displayAll2));
+    EXPECT_EQ("333333333", ocr::ParseDisplay(s_displayAll3));
+    EXPECT_EQ("444444444", ocr::ParseDisplay(s_displayAll4));
+    EXPECT_EQ("555555555", ocr::ParseDisplay(s_displayAll5));
+    EXPECT_EQ("666666666", ocr::ParseDisplay(s_displayAll6));
+    EXPECT_EQ("777777777", ocr::ParseDisplay(s_displayAll7));
+    EXPECT_EQ("888888888", ocr::ParseDisplay(s_displayAll8));
+    EXPECT_EQ("999999999", ocr::ParseDisplay(s_displayAll9));
+    EXPECT_EQ("123456789", ocr::ParseDisplay(s_display123456789));
+}
+
+TEST(BankOcr, ParseDisplayWithTrimmedLines)
+{
+    const Display display = { "    _  _     _  _  _  _  _",
+                              "  | _| _||_||_ |_   ||_||_|",
+                              "  ||_  _|  | _||_|  ||_| _|"
+    };
+    EXPECT_EQ("123456789", ocr::ParseDisplay(display));
+}
+
+TEST(BankOcr, ParseEmptyFile)
+{
+    EXPECT_TRUE(ocr::ParseEntries("").empty());
+}
+
+TEST(BankOcr, ParseFile)
+{
+    const std::string text = FormatEntry(s_display123456789) + FormatEntry(s_displayAll1);
+    EXPECT_EQ(std::vector<std::string>({ "123456789", "111111111" }), ocr::ParseEntries(text));
+}
+
+TEST(BankOcr, ParseFileWithoutLastSeparator)
+{
+    const std::string text = FormatEntry(s_displayAll4) + s_displayAll0.lines[0] + "\n" +
+            s_displayAll0.lines[1] + "\n" + s_displayAll0.lines[2];
+    EXPECT_EQ(std::vector<std::string>({ "444444444", "000000000" }), ocr::ParseEntries(text));
+}
+
+TEST(BankOcr, ParseFileWithWindowsLineEndings)
+{
+    const std::string text = s_displayAll7.lines[0] + "\r\n" + s_displayAll7.lines[1] + "\r\n" +
+            s_displayAll7.lines[2] + "\r\n\r\n";
+    EXPECT_EQ(std::vector<std::string>({ "777777777" }), ocr::ParseEntries(text));
+}
+
+TEST(BankOcr, IncompleteLastEntryIsSkipped)
+{
+    const std::string text = FormatEntry(s_displayAll8) + s_displayAll9.lines[0] + "\n" + s_displayAll9.lines[1];
+    EXPECT_EQ(std::vector<std::string>({ "888888888" }), ocr::ParseEntries(text));
+}
+
+TEST(BankOcr, ChunksStartAtRecordBoundaries)
+{
+    const std::string text = MakeScanFile(100);
+    size_t linesCount = 0;
+    const std::vector<ocr::Chunk> chunks = ocr::FindChunks(text, 7, 3, linesCount);
+
+    EXPECT_EQ(400u, linesCount);
+    ASSERT_EQ(7u, chunks.size());
+    EXPECT_EQ(0u, chunks[0].offset);
+    for (const ocr::Chunk& chunk : chunks)
+    {
+        const size_t entryLen = (g_lineLen + 1) * g_linesInDigit + 1;
+        EXPECT_EQ(chunk.firstEntry * entryLen, chunk.offset);
+    }
+}
+
+TEST(BankOcr, ChunksOfTinyFile)
+{
+    const std::string text = MakeScanFile(2);
+    size_t linesCount = 0;
+    const std::vector<ocr::Chunk> chunks = ocr::FindChunks(text, 16, 4, linesCount);
+
+    ASSERT_EQ(2u, chunks.size());
+    EXPECT_EQ(1u, chunks[1].firstEntry);
+}
+
+TEST(BankOcr, ParallelParseKeepsOrder)
+{
+    const std::string text = MakeScanFile(1001);
+    const std::vector<std::string> expected = ocr::ParseEntries(text);
+
+    for (unsigned threads = 1; threads <= 8; ++threads)
+    {
+        EXPECT_EQ(expected, ocr::ParseEntriesParallel(text, threads));
+    }
+}
+
+TEST(BankOcr, ParallelParseOfEmptyFile)
+{
+    EXPECT_TRUE(ocr::ParseEntriesParallel("", 4).empty());
+}
+
+namespace
+{
+    std::string DecodeWith(ocr::GlyphKernel kernel, const Display& display)
+    {
+        const char* lines[g_linesInDigit];
+        size_t lengths[g_linesInDigit];
+        for (unsigned short row = 0; row < g_linesInDigit; ++row)
+        {
+            lines[row] = display.lines[row].data();
+            lengths[row] = display.lines[row].size();
+        }
+        std::string account(g_digitsOnDisplay, ' ');
+        ocr::DecodeEntry(kernel, lines, lengths, &account[0]);
+        return account;
+    }
+
+    const ocr::GlyphKernel s_glyphKernels[] = { ocr::GlyphKernel::Scalar, ocr::GlyphKernel::Sse2, ocr::GlyphKernel::Avx2 };
+}
+
+TEST(BankOcr, ScalarGlyphKernelIsAlwaysSupported)
+{
+    EXPECT_TRUE(ocr::IsGlyphKernelSupported(ocr::GlyphKernel::Scalar));
+    EXPECT_TRUE(ocr::IsGlyphKernelSupported(ocr::GetBestGlyphKernel()));
+}
+
+TEST(BankOcr, GlyphKernelsDecodeDisplays)
+{
+    const Display* displays[] = { &s_displayAll0, &s_displayAll1, &s_displayAll2, &s_displayAll3, &s_displayAll4,
+                                  &s_displayAll5, &s_displayAll6, &s_displayAll7, &s_displayAll8, &s_displayAll9,
+                                  &s_display123456789 };
+    for (ocr::GlyphKernel kernel : s_glyphKernels)
+    {
+        if (!ocr::IsGlyphKernelSupported(kernel))
+        {
+            continue;
+        }
+        for (const Display* display : displays)
+        {
+            EXPECT_EQ(ocr::ParseDisplay(*display), DecodeWith(kernel, *display));
+        }
+    }
+}
+
+TEST(BankOcr, GlyphKernelsAgreeOnNoise)
+{
+    const char symbols[] = { ' ', '_', '|', 'x' };
+    unsigned seed = 12345;
+    for (int iteration = 0; iteration < 1000; ++iteration)
+    {
+        Display display;
+        for (std::string& line : display.lines)
+        {
+            line.resize(g_lineLen);
+            for (char& symbol : line)
+            {
+                seed = seed * 1103515245 + 12345;
+                symbol = symbols[(seed >> 16) % 4];
+            }
+        }
+
+        const std::string expected = DecodeWith(ocr::GlyphKernel::Scalar, display);
+        for (ocr::GlyphKernel kernel : s_glyphKernels)
+        {
+            if (ocr::IsGlyphKernelSupported(kernel))
+            {
+                EXPECT_EQ(expected, DecodeWith(kernel, display));
+            }
+        }
+    }
+}
+
+TEST(BankOcr, ValidAccount)
+{
+    EXPECT_EQ(AccountStatus::Valid, ocr::ValidateAccount("345882865"));
+    EXPECT_EQ(AccountStatus::Valid, ocr::ValidateAccount("457508000"));
+}
+
+TEST(BankOcr, AccountWithWrongChecksum)
+{
+    EXPECT_EQ(AccountStatus::Error, ocr::ValidateAccount("664371495"));
+}
+
+TEST(BankOcr, IllegibleAccount)
+{
+    EXPECT_EQ(AccountStatus::Illegible, ocr::ValidateAccount("86110??36"));
+}
+
+TEST(BankOcr, PackAccountsByColumns)
+{
+    const ocr::AccountColumns columns = ocr::PackAccounts({ "123456789", "987654321" });
+    ASSERT_EQ(2u, columns.count);
+    EXPECT_EQ('1', columns.Column(0)[0]);
+    EXPECT_EQ('9', columns.Column(0)[1]);
+    EXPECT_EQ('9', columns.Column(8)[0]);
+    EXPECT_EQ('1', columns.Column(8)[1]);
+}
+
+TEST(BankOcr, BulkValidationMatchesSingle)
+{
+    std::vector<std::string> accounts;
+    unsigned seed = 42;
+    for (int i = 0; i < 1000; ++i)
+    {
+        std::string account(g_digitsOnDisplay, '0');
+        for (char& digit : account)
+        {
+            seed = seed * 1103515245 + 12345;
+            const unsigned value = (seed >> 16) % 11;
+            digit = value == 10 ? ocr::s_illegibleDigit : static_cast<char>('0' + value);
+        }
+        accounts.push_back(account);
+    }
+
+    std::vector<AccountStatus> statuses(accounts.size());
+    ocr::ValidateAccounts(ocr::PackAccounts(accounts), statuses.data());
+    for (size_t i = 0; i < accounts.size(); ++i)
+    {
+        EXPECT_EQ(ocr::ValidateAccount(accounts[i].data()), statuses[i]) << accounts[i];
+    }
+}
+
+TEST(BankOcr, WriteStatusReport)
+{
+    std::ostringstream report;
+    ocr::WriteStatusReport({ "457508000", "664371495", "86110??36" }, report);
+    EXPECT_EQ("457508000\n664371495 ERR\n86110??36 ILL\n", report.str());
+}
+
+TEST(BankOcr, WriteStatusReportOfManyBatches)
+{
+    const std::vector<std::string> accounts(ocr::g_reportBatch * 2 + 1, "345882865");
+    std::ostringstream report;
+    ocr::WriteStatusReport(accounts, report);
+    EXPECT_EQ((g_digitsOnDisplay + 1) * accounts.size(), report.str().size());
+}
+
+TEST(BankOcr, StatusReportWriterStreamsBatches)
+{
+    std::ostringstream report;
+    StatusReportWriter writer(report);
+    const AccountStatus statuses[] = { AccountStatus::Error, AccountStatus::Valid };
+    writer.Write(ocr::PackAccounts({ "111111111", "000000000" }), statuses);
+    const AccountStatus illegible[] = { AccountStatus::Illegible };
+    writer.Write(ocr::PackAccounts({ "1?1111111" }), illegible);
+    EXPECT_EQ("111111111 ERR\n000000000\n1?1111111 ILL\n", report.str());
+}
+
+TEST(BankOcr, GlyphNeighboursOfEight)
+{
+    const GlyphNeighbours& neighbours = ocr::GetGlyphNeighbours(ocr::GetGlyphMask(s_digit8));
+    EXPECT_EQ("069", std::string(neighbours.digits, neighbours.count));
+}
+
+TEST(BankOcr, GlyphNeighboursOfOne)
+{
+    const GlyphNeighbours& neighbours = ocr::GetGlyphNeighbours(ocr::GetGlyphMask(s_digit1));
+    EXPECT_EQ("7", std::string(neighbours.digits, neighbours.count));
+}
+
+TEST(BankOcr, ValidAccountIsNotResolved)
+{
+    EXPECT_EQ("123456789", ocr::FormatResolution(ocr::ResolveDisplay(s_display123456789)));
+}
+
+TEST(BankOcr, ResolveSingleCorrection)
+{
+    EXPECT_EQ("711111111", ocr::FormatResolution(ocr::ResolveDisplay(s_displayAll1)));
+    EXPECT_EQ("777777177", ocr::FormatResolution(ocr::ResolveDisplay(s_displayAll7)));
+    EXPECT_EQ("333393333", ocr::FormatResolution(ocr::ResolveDisplay(s_displayAll3)));
+
+    const Display display = { " _  _  _  _  _  _  _  _  _ ",
+                              " _|| || || || || || || || |",
+                              "|_ |_||_||_||_||_||_||_||_|"
+    };
+    EXPECT_EQ("200800000", ocr::FormatResolution(ocr::ResolveDisplay(display)));
+}
+
+TEST(BankOcr, ResolveAmbiguousAccounts)
+{
+    EXPECT_EQ("888888888 AMB ['888886888', '888888880', '888888988']",
+              ocr::FormatResolution(ocr::ResolveDisplay(s_displayAll8)));
+    EXPECT_EQ("555555555 AMB ['555655555', '559555555']",
+              ocr::FormatResolution(ocr::ResolveDisplay(s_displayAll5)));
+    EXPECT_EQ("666666666 AMB ['666566666', '686666666']",
+              ocr::FormatResolution(ocr::ResolveDisplay(s_displayAll6)));
+    EXPECT_EQ("999999999 AMB ['899999999', '993999999', '999959999']",
+              ocr::FormatResolution(ocr::ResolveDisplay(s_displayAll9)));
+
+    const Display display = { "    _  _  _  _  _  _     _ ",
+                              "|_||_|| || ||_   |  |  ||_ ",
+                              "  | _||_||_||_|  |  |  | _|"
+    };
+    EXPECT_EQ("490067715 AMB ['490067115', '490067719', '490867715']",
+              ocr::FormatResolution(ocr::ResolveDisplay(display)));
+}
+
+TEST(BankOcr, ResolveIllegibleDigit)
+{
+    const Display brokenOne = { "    _  _     _  _  _  _  _ ",
+                                " _| _| _||_||_ |_   ||_||_|",
+                                "  ||_  _|  | _||_|  ||_| _|"
+    };
+    EXPECT_EQ("123456789", ocr::FormatResolution(ocr::ResolveDisplay(brokenOne)));
+
+    const Display brokenFive = { " _     _  _  _  _  _  _    ",
+                                 "| || || || || || || ||_   |",
+                                 "|_||_||_||_||_||_||_| _|  |"
+    };
+    EXPECT_EQ("000000051", ocr::FormatResolution(ocr::ResolveDisplay(brokenFive)));
+
+    const Display brokenNine = { "    _  _  _  _  _  _     _ ",
+                                 "|_||_|| ||_||_   |  |  | _ ",
+                                 "  | _||_||_||_|  |  |  | _|"
+    };
+    EXPECT_EQ("490867715", ocr::FormatResolution(ocr::ResolveDisplay(brokenNine)));
+}
+
+TEST(BankOcr, UnresolvableAccountsKeepStatus)
+{
+    const Display twoIllegible = { "                           ",
+                                   "  |  |  |  |  |  |  || || |",
+                                   "  |  |  |  |  |  |  || || |"
+    };
+    EXPECT_EQ("1111111?? ILL", ocr::FormatResolution(ocr::ResolveDisplay(twoIllegible)));
+}
+
+namespace
+{
+    // Some scanner models print 7 with a stem on the left and 9 without a tail
+    constexpr Font s_hookedFont = { {
+        { " _ ", "| |", "|_|" },
+        { "   ", "  |", "  |" },
+        { " _ ", " _|", "|_ " },
+        { " _ ", " _|", " _|" },
+        { "   ", "|_|", "  |" },
+        { " _ ", "|_ ", " _|" },
+        { " _ ", "|_ ", "|_|" },
+        { " _ ", "| |", "  |" },
+        { " _ ", "|_|", "|_|" },
+        { " _ ", "|_|", "  |" }
+    } };
+    static_assert(ocr::IsFontValid(s_hookedFont), "hooked font must be valid");
+    constexpr DigitsLookup s_hookedDigits = ocr::MakeDigitsLookup(s_hookedFont);
+
+    constexpr Font s_collidingFont = { {
+        { " _ ", "| |", "|_|" },
+        { "   ", "  |", "  |" },
+        { " _ ", " _|", "|_ " },
+        { " _ ", " _|", " _|" },
+        { "   ", "|_|", "  |" },
+        { " _ ", "|_ ", " _|" },
+        { " _ ", "|_ ", "|_|" },
+        { "   ", "  |", "  |" },
+        { " _ ", "|_|", "|_|" },
+        { " _ ", "|_|", " _|" }
+    } };
+    static_assert(ocr::HasCollisions(s_collidingFont), "7 drawn as 1 must collide");
+
+    constexpr Font s_malformedFont = { {
+        { " _ ", "| |", "|_|" },
+        { "   ", "  |", "  |" },
+        { " _ ", " _|", "|_ " },
+        { " _ ", " _|", " _|" },
+        { "   ", "|_|", "  |" },
+        { " _ ", "|_ ", " _|" },
+        { " _ ", "|_ ", "|_|" },
+        { " _ ", "  /", "  /" },
+        { " _ ", "|_|", "|_|" },
+        { " _ ", "|_|", " _|" }
+    } };
+    static_assert(!ocr::IsFontValid(s_malformedFont), "strokes other than '_' and '|' are rejected");
+
+    static_assert(ocr::s_standardDigits.digits[ocr::FontGlyphMask(ocr::s_standardFont, 8)] == '8',
+                  "standard table is built at compile time");
+}
+
+TEST(BankOcr, StandardFontMatchesDigits)
+{
+    EXPECT_EQ(ocr::FontGlyphMask(ocr::s_standardFont, 0), ocr::GetGlyphMask(s_digit0));
+    EXPECT_EQ(ocr::FontGlyphMask(ocr::s_standardFont, 5), ocr::GetGlyphMask(s_digit5));
+    EXPECT_EQ(ocr::FontGlyphMask(ocr::s_standardFont, 9), ocr::GetGlyphMask(s_digit9));
+}
+
+TEST(BankOcr, ParseDisplayWithAnotherFont)
+{
+    const Display display = { "    _  _     _  _  _  _  _ ",
+                              "  | _| _||_||_ |_ | ||_||_|",
+                              "  ||_  _|  | _||_|  ||_|  |"
+    };
+    EXPECT_EQ("123456789", ocr::ParseDisplay(display, s_hookedDigits));
+    EXPECT_EQ("123456?8?", ocr::ParseDisplay(display));
+}
+
+TEST(BankOcr, FollowerDecodesCompleteRecords)
+{
+    std::vector<std::string> accounts;
+    ScanFollower follower([&](const std::string& account) { accounts.push_back(account); });
+
+    const std::string text = MakeScanFile(9);
+    follower.Append(text.data(), text.size());
+
+    EXPECT_EQ(ocr::ParseEntries(text), accounts);
+    EXPECT_EQ(text.size(), follower.GetDecodedOffset());
+    EXPECT_EQ(9u, follower.GetDecodedEntries());
+}
+
+TEST(BankOcr, FollowerWaitsForSeparatorLine)
+{
+    std::vector<std::string> accounts;
+    ScanFollower follower([&](const std::string& account) { accounts.push_back(account); });
+
+    const std::string entry = FormatEntry(s_display123456789);
+    follower.Append(entry.data(), entry.size() - 1);
+    EXPECT_TRUE(accounts.empty());
+    EXPECT_EQ(0u, follower.GetDecodedOffset());
+    EXPECT_EQ(entry.size() - 1, follower.GetReadOffset());
+
+    follower.Append("\n", 1);
+    EXPECT_EQ(std::vector<std::string>({ "123456789" }), accounts);
+    EXPECT_EQ(entry.size(), follower.GetDecodedOffset());
+}
+
+TEST(BankOcr, FollowerAcceptsAnySplitOfInput)
+{
+    const std::string text = MakeScanFile(5);
+    std::vector<std::string> accounts;
+    ScanFollower follower([&](const std::string& account) { accounts.push_back(account); });
+
+    for (size_t i = 0; i < text.size(); i += 7)
+    {
+        follower.Append(text.data() + i, std::min<size_t>(7, text.size() - i));
+    }
+    EXPECT_EQ(ocr::ParseEntries(text), accounts);
+}
+
+TEST(BankOcr, FollowerResumesFromOffset)
+{
+    const std::string entry = FormatEntry(s_displayAll4);
+    ScanFollower follower([](const std::string&) {}, 1000);
+    follower.Append(entry.data(), entry.size());
+    EXPECT_EQ(1000 + entry.size(), follower.GetDecodedOffset());
+}
+
+TEST(BankOcr, FileFollowerReadsAppendedEntries)
+{
+    const std::string path = testing::TempDir() + "bank_ocr_follow.txt";
+    std::ofstream(path, std::ios::binary | std::ios::trunc);
+
+    std::vector<std::string> accounts;
+    ScanFollower follower([&](const std::string& account) { accounts.push_back(account); });
+    FileFollower fileFollower(path, follower);
+    EXPECT_EQ(0u, fileFollower.Poll());
+
+    const std::string first = FormatEntry(s_displayAll0);
+    const std::string second = FormatEntry(s_displayAll1);
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::app);
+        file << first << second.substr(0, 30);
+    }
+    EXPECT_EQ(1u, fileFollower.Poll());
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::app);
+        file << second.substr(30);
+    }
+    EXPECT_EQ(1u, fileFollower.Poll());
+    EXPECT_EQ(std::vector<std::string>({ "000000000", "111111111" }), accounts);
+
+    std::remove(path.c_str());
+}
+
+TEST(BankOcr, FileFollowerRestartsOnTruncatedFile)
+{
+    const std::string path = testing::TempDir() + "bank_ocr_rotate.txt";
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << MakeScanFile(3);
+
+    std::vector<std::string> accounts;
+    ScanFollower follower([&](const std::string& account) { accounts.push_back(account); });
+    FileFollower fileFollower(path, follower);
+    EXPECT_EQ(3u, fileFollower.Poll());
+
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << FormatEntry(s_displayAll9);
+    EXPECT_EQ(1u, fileFollower.Poll());
+    EXPECT_EQ("999999999", accounts.back());
+
+    std::remove(path.c_str());
+}
+
+TEST(BankOcr, FileFollowerRestartsOnRewrittenFile)
+{
+    const std::string path = testing::TempDir() + "bank_ocr_rewrite.txt";
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << FormatEntry(s_displayAll4) << FormatEntry(s_display123456789);
+
+    std::vector<std::string> accounts;
+    ScanFollower follower([&](const std::string& account) { accounts.push_back(account); });
+    FileFollower fileFollower(path, follower);
+    EXPECT_EQ(2u, fileFollower.Poll());
+
+    // Truncated and written past the old end between polls, the size alone doesn't tell
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << MakeScanFile(3);
+    EXPECT_EQ(3u, fileFollower.Poll());
+    accounts.erase(accounts.begin(), accounts.begin() + 2);
+    EXPECT_EQ(ocr::ParseEntries(MakeScanFile(3)), accounts);
+
+    // Replaced by another file, which starts the same way
+    const std::string replacement = path + ".new";
+    std::ofstream(replacement, std::ios::binary | std::ios::trunc) << MakeScanFile(4);
+    std::rename(replacement.c_str(), path.c_str());
+    EXPECT_EQ(4u, fileFollower.Poll());
+
+    std::remove(path.c_str());
+}
+
+TEST(BankOcr, FileFollowerFollowsInBackground)
+{
+    const std::string path = testing::TempDir() + "bank_ocr_background.txt";
+    std::ofstream(path, std::ios::binary | std::ios::trunc);
+
+    std::atomic<size_t> entries(0);
+    ScanFollower follower([&](const std::string&) { ++entries; });
+    FileFollower fileFollower(path, follower);
+    std::atomic<bool> stop(false);
+    std::thread worker([&]() { fileFollower.Follow(stop, std::chrono::milliseconds(10)); });
+
+    std::ofstream(path, std::ios::binary | std::ios::app) << MakeScanFile(2);
+    for (int attempt = 0; attempt < 500 && entries < 2; ++attempt)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    stop = true;
+    worker.join();
+
+    EXPECT_EQ(2u, entries);
+    std::remove(path.c_str());
+}
+
+TEST(BankOcr, PackAccount)
+{
+    uint32_t packed = 0;
+    ASSERT_TRUE(ocr::PackAccount("000000051", packed));
+    EXPECT_EQ(51u, packed);
+    ASSERT_TRUE(ocr::PackAccount("999999999", packed));
+    EXPECT_EQ(999999999u, packed);
+    EXPECT_EQ("000000051", ocr::UnpackAccount(51));
+}
+
+TEST(BankOcr, IllegibleAccountIsNotPacked)
+{
+    uint32_t packed = 0;
+    EXPECT_FALSE(ocr::PackAccount("86110??36", packed));
+}
+
+TEST(BankOcr, HashSetDetectsDuplicates)
+{
+    AccountHashSet set;
+    for (uint32_t account = 0; account < 1000; ++account)
+    {
+        EXPECT_TRUE(set.Insert(account * 7919));
+    }
+    EXPECT_FALSE(set.Insert(7919));
+    EXPECT_TRUE(set.Contains(999 * 7919));
+    EXPECT_FALSE(set.Contains(1));
+    EXPECT_EQ(1000u, set.Size());
+}
+
+TEST(BankOcr, BloomFilterHasNoFalseNegatives)
+{
+    AccountBloomFilter filter(1000);
+    for (uint32_t account = 0; account < 1000; ++account)
+    {
+        filter.Add(account * 104729);
+    }
+    size_t falsePositives = 0;
+    for (uint32_t account = 0; account < 1000; ++account)
+    {
+        EXPECT_TRUE(filter.MayContain(account * 104729));
+        falsePositives += filter.MayContain(account * 104729 + 1);
+    }
+    EXPECT_LT(falsePositives, 50u);
+}
+
+TEST(BankOcr, StoreDeduplicatesAccounts)
+{
+    AccountStore store(1000);
+    EXPECT_TRUE(store.Add(345882865));
+    EXPECT_TRUE(store.Add(457508000));
+    EXPECT_FALSE(store.Add(345882865));
+    EXPECT_TRUE(store.Contains(457508000));
+    EXPECT_FALSE(store.Contains(664371495));
+    EXPECT_EQ(2u, store.Size());
+}
+
+TEST(BankOcr, StoreKeepsAccountsAfterCompaction)
+{
+    AccountStore store(10000);
+    unsigned seed = 7;
+    std::vector<uint32_t> accounts;
+    for (int i = 0; i < 20000; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        const uint32_t account = seed % 1000000000;
+        store.Add(account);
+        accounts.push_back(account);
+    }
+    std::sort(accounts.begin(), accounts.end());
+    accounts.erase(std::unique(accounts.begin(), accounts.end()), accounts.end());
+
+    EXPECT_EQ(accounts.size(), store.Size());
+    for (uint32_t account : accounts)
+    {
+        ASSERT_TRUE(store.Contains(account));
+        ASSERT_FALSE(store.Add(account));
+    }
+
+    std::vector<uint32_t> visited;
+    store.ForEach([&](uint32_t account) { visited.push_back(account); });
+    EXPECT_EQ(accounts, visited);
+}
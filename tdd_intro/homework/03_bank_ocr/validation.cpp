@@ -0,0 +1,113 @@
+#include "validation.h"
+#include <algorithm>
+
+unsigned ocr::ChecksumOf(const char account[g_digitsOnDisplay])
+{
+    unsigned sum = 0;
+    for (unsigned short position = 0; position < g_digitsOnDisplay; ++position)
+    {
+        sum += (g_digitsOnDisplay - position) * static_cast<unsigned>(account[position] - '0');
+    }
+    return sum;
+}
+
+AccountStatus ocr::ValidateAccount(const char account[g_digitsOnDisplay])
+{
+    unsigned illegible = 0;
+    for (unsigned short position = 0; position < g_digitsOnDisplay; ++position)
+    {
+        illegible |= static_cast<unsigned>(account[position] - '0') > 9;
+    }
+    if (illegible)
+    {
+        return AccountStatus::Illegible;
+    }
+    return ChecksumOf(account) % g_checksumModulo == 0 ? AccountStatus::Valid : AccountStatus::Error;
+}
+
+ocr::AccountColumns ocr::PackAccounts(const std::vector<std::string>& accounts)
+{
+    AccountColumns columns;
+    PackAccounts(accounts.data(), accounts.size(), columns);
+    return columns;
+}
+
+void ocr::PackAccounts(const std::string* accounts, size_t count, AccountColumns& columns)
+{
+    columns.count = count;
+    columns.digits.assign(count * g_digitsOnDisplay, s_illegibleDigit);
+    for (size_t index = 0; index < count; ++index)
+    {
+        const std::string& account = accounts[index];
+        const size_t length = std::min<size_t>(account.size(), g_digitsOnDisplay);
+        for (unsigned short position = 0; position < length; ++position)
+        {
+            columns.digits[position * count + index] = account[position];
+        }
+    }
+}
+
+namespace
+{
+    // Digit with a wrap around for anything below '0', so one comparison catches all non-digits
+    inline unsigned DigitAt(const unsigned char* column, size_t index)
+    {
+        return column[index] - static_cast<unsigned>('0');
+    }
+
+    // Accounts in a block: gcc vectorizes a loop of a fixed count at -O2 already,
+    // a loop with a remainder only at -O3
+    const size_t s_blockSize = 16;
+
+    // Columns come one by one, so the loop over accounts is the only loop here,
+    // and restrict tells the compiler that statuses don't overlap digits.
+    template<size_t count>
+    void ValidateBlock(const unsigned char* __restrict d9, const unsigned char* __restrict d8,
+                       const unsigned char* __restrict d7, const unsigned char* __restrict d6,
+                       const unsigned char* __restrict d5, const unsigned char* __restrict d4,
+                       const unsigned char* __restrict d3, const unsigned char* __restrict d2,
+                       const unsigned char* __restrict d1, size_t first, uint8_t* __restrict statuses)
+    {
+        for (size_t i = first; i < first + count; ++i)
+        {
+            const unsigned illegible = (DigitAt(d1, i) > 9) | (DigitAt(d2, i) > 9) | (DigitAt(d3, i) > 9) |
+                                       (DigitAt(d4, i) > 9) | (DigitAt(d5, i) > 9) | (DigitAt(d6, i) > 9) |
+                                       (DigitAt(d7, i) > 9) | (DigitAt(d8, i) > 9) | (DigitAt(d9, i) > 9);
+            const unsigned sum = DigitAt(d1, i) + 2 * DigitAt(d2, i) + 3 * DigitAt(d3, i) +
+                                 4 * DigitAt(d4, i) + 5 * DigitAt(d5, i) + 6 * DigitAt(d6, i) +
+                                 7 * DigitAt(d7, i) + 8 * DigitAt(d8, i) + 9 * DigitAt(d9, i);
+            const unsigned error = sum % ocr::g_checksumModulo != 0;
+            // Illegible wins over checksum error: 0 - valid, 1 - illegible, 2 - error
+            statuses[i] = static_cast<uint8_t>(illegible | ((error & ~illegible) << 1));
+        }
+    }
+
+    void ValidateColumns(const unsigned char* d9, const unsigned char* d8, const unsigned char* d7,
+                         const unsigned char* d6, const unsigned char* d5, const unsigned char* d4,
+                         const unsigned char* d3, const unsigned char* d2, const unsigned char* d1,
+                         size_t count, uint8_t* statuses)
+    {
+        size_t first = 0;
+        for (; first + s_blockSize <= count; first += s_blockSize)
+        {
+            ValidateBlock<s_blockSize>(d9, d8, d7, d6, d5, d4, d3, d2, d1, first, statuses);
+        }
+        for (; first < count; ++first)
+        {
+            ValidateBlock<1>(d9, d8, d7, d6, d5, d4, d3, d2, d1, first, statuses);
+        }
+    }
+
+    const unsigned char* ColumnOf(const ocr::AccountColumns& accounts, unsigned short position)
+    {
+        return reinterpret_cast<const unsigned char*>(accounts.Column(position));
+    }
+}
+
+void ocr::ValidateAccounts(const AccountColumns& accounts, AccountStatus* statuses)
+{
+    ValidateColumns(ColumnOf(accounts, 0), ColumnOf(accounts, 1), ColumnOf(accounts, 2),
+                    ColumnOf(accounts, 3), ColumnOf(accounts, 4), ColumnOf(accounts, 5),
+                    ColumnOf(accounts, 6), ColumnOf(accounts, 7), ColumnOf(accounts, 8),
+                    accounts.count, reinterpret_cast<uint8_t*>(statuses));
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "ocr.h"
+#include <cstdint>
+
+/*
+ * Account number:  3  4  5  8  8  2  8  6  5
+ * Position names:  d9 d8 d7 d6 d5 d4 d3 d2 d1
+ *
+ * Checksum calculation:
+ * (d1 + 2*d2 + 3*d3 + ... + 9*d9) mod 11 = 0
+ */
+
+enum class AccountStatus : uint8_t
+{
+    Valid,
+    Illegible,  // ILL - some digit was not recognized
+    Error,      // ERR - all digits are read, but checksum fails
+    Ambiguous   // AMB - several one stroke corrections pass the checksum
+};
+
+namespace ocr
+{
+    const unsigned short g_checksumModulo = 11;
+
+    // Weighted sum of the digits without the modulo, expects '0'..'9' only
+    unsigned ChecksumOf(const char account[g_digitsOnDisplay]);
+    AccountStatus ValidateAccount(const char account[g_digitsOnDisplay]);
+
+    /*
+     * Accounts stored digit position major: all first digits, then all second digits and so on.
+     * This way each step over accounts reads contiguous memory.
+     */
+    struct AccountColumns
+    {
+        size_t count = 0;
+        std::vector<char> digits;
+
+        const char* Column(unsigned short position) const { return digits.data() + position * count; }
+    };
+
+    AccountColumns PackAccounts(const std::vector<std::string>& accounts);
+    // Same, but reuses storage of columns
+    void PackAccounts(const std::string* accounts, size_t count, AccountColumns& columns);
+
+    // The loop is free of data dependent branches, so the compiler vectorizes it over accounts.
+    // statuses must have room for accounts.count items.
+    void ValidateAccounts(const AccountColumns& accounts, AccountStatus* statuses);
+}
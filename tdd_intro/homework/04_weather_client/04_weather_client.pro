@@ -2,9 +2,43 @@ include(../../gmock.pri)
 include(../../gtest.pri)
 
 TEMPLATE = app
-CONFIG += console c++11
+CONFIG += console c++17
 CONFIG -= app_bundle
 CONFIG -= qt
 
 SOURCES += \
-    test.cpp
+    test.cpp \
+    benchmark.cpp \
+    weather.cpp \
+    weatherclient.cpp \
+    fakeweatherserver.cpp \
+    cachingweatherserver.cpp \
+    batchweatherserveradapter.cpp \
+    asyncweatherserver.cpp \
+    weatherseries.cpp \
+    statskernels.cpp \
+    weatherfile.cpp \
+    persistentweatherserver.cpp \
+    simulatedweatherserver.cpp \
+    socketweatherserver.cpp \
+    cityweatheraggregator.cpp
+
+HEADERS += \
+    iweatherserver.h \
+    ibatchweatherserver.h \
+    iweatherclient.h \
+    iclock.h \
+    mocks.h \
+    weather.h \
+    weatherclient.h \
+    fakeweatherserver.h \
+    cachingweatherserver.h \
+    batchweatherserveradapter.h \
+    asyncweatherserver.h \
+    weatherseries.h \
+    statskernels.h \
+    weatherfile.h \
+    persistentweatherserver.h \
+    simulatedweatherserver.h \
+    socketweatherserver.h \
+    cityweatheraggregator.h
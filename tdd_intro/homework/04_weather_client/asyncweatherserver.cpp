@@ -0,0 +1,121 @@
+#include "asyncweatherserver.h"
+#include <algorithm>
+
+AsyncWeatherServer::AsyncWeatherServer(IWeatherServer& upstream, unsigned concurrencyLimit)
+    : m_upstream(upstream)
+    , m_upstreamCalls(0)
+    , m_stopping(false)
+{
+    const unsigned workersCount = std::max(concurrencyLimit, 1u);
+    m_workers.reserve(workersCount);
+    for (unsigned i = 0; i < workersCount; ++i)
+    {
+        m_workers.emplace_back(&AsyncWeatherServer::Work, this);
+    }
+}
+
+AsyncWeatherServer::~AsyncWeatherServer()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_tasksReady.notify_all();
+    for (std::thread& worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+std::shared_future<std::string> AsyncWeatherServer::GetWeatherAsync(const std::string& request)
+{
+    std::shared_future<std::string> response;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto inFlight = m_inFlight.find(request);
+        if (inFlight != m_inFlight.end())
+        {
+            return inFlight->second;
+        }
+
+        Task task = { request, std::promise<std::string>() };
+        response = task.response.get_future().share();
+        m_inFlight.emplace(request, response);
+        m_tasks.push_back(std::move(task));
+    }
+    m_tasksReady.notify_one();
+    return response;
+}
+
+std::string AsyncWeatherServer::GetWeather(const std::string& request)
+{
+    return GetWeatherAsync(request).get();
+}
+
+std::vector<std::string> AsyncWeatherServer::GetWeatherBatch(const std::vector<std::string>& requests)
+{
+    std::vector<std::shared_future<std::string>> pending;
+    pending.reserve(requests.size());
+    for (const std::string& request : requests)
+    {
+        pending.push_back(GetWeatherAsync(request));
+    }
+
+    std::vector<std::string> responses;
+    responses.reserve(requests.size());
+    for (const std::shared_future<std::string>& response : pending)
+    {
+        responses.push_back(response.get());
+    }
+    return responses;
+}
+
+size_t AsyncWeatherServer::GetUpstreamCalls() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_upstreamCalls;
+}
+
+void AsyncWeatherServer::Work()
+{
+    while (true)
+    {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_tasksReady.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+            if (m_tasks.empty())
+            {
+                return;
+            }
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+            ++m_upstreamCalls;
+        }
+
+        std::string response;
+        std::exception_ptr error;
+        try
+        {
+            response = m_upstream.GetWeather(task.request);
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        // Later requests for the same key go upstream again, as they may get a fresher answer
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_inFlight.erase(task.request);
+        }
+        if (error)
+        {
+            task.response.set_exception(error);
+        }
+        else
+        {
+            task.response.set_value(std::move(response));
+        }
+    }
+}
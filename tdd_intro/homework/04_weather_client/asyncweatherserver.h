@@ -0,0 +1,51 @@
+#pragma once
+#include "ibatchweatherserver.h"
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+/*
+ * Sends requests to another server from a fixed number of worker threads,
+ * so at most concurrencyLimit requests are in flight at once.
+ * Identical requests which are in flight at the same time share one upstream call.
+ * The upstream server must allow calls from several threads.
+ */
+class AsyncWeatherServer : public IBatchWeatherServer
+{
+public:
+    AsyncWeatherServer(IWeatherServer& upstream, unsigned concurrencyLimit);
+    ~AsyncWeatherServer();
+
+    AsyncWeatherServer(const AsyncWeatherServer&) = delete;
+    AsyncWeatherServer& operator=(const AsyncWeatherServer&) = delete;
+
+    // Exceptions of the upstream call are rethrown by get()
+    std::shared_future<std::string> GetWeatherAsync(const std::string& request);
+
+    std::string GetWeather(const std::string& request) override;
+    // Requests of the batch run concurrently
+    std::vector<std::string> GetWeatherBatch(const std::vector<std::string>& requests) override;
+
+    size_t GetUpstreamCalls() const;
+
+private:
+    struct Task
+    {
+        std::string request;
+        std::promise<std::string> response;
+    };
+
+    void Work();
+
+    IWeatherServer& m_upstream;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_tasksReady;
+    std::deque<Task> m_tasks;
+    std::unordered_map<std::string, std::shared_future<std::string>> m_inFlight;
+    size_t m_upstreamCalls;
+    bool m_stopping;
+    std::vector<std::thread> m_workers;
+};
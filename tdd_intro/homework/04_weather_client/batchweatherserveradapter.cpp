@@ -0,0 +1,40 @@
+#include "batchweatherserveradapter.h"
+#include <stdexcept>
+
+BatchWeatherServerAdapter::BatchWeatherServerAdapter(IWeatherServer& server)
+    : m_server(server)
+{
+}
+
+std::string BatchWeatherServerAdapter::GetWeather(const std::string& request)
+{
+    return m_server.GetWeather(request);
+}
+
+std::vector<std::string> BatchWeatherServerAdapter::GetWeatherBatch(const std::vector<std::string>& requests)
+{
+    std::vector<std::string> responses;
+    responses.reserve(requests.size());
+    for (const std::string& request : requests)
+    {
+        responses.push_back(m_server.GetWeather(request));
+    }
+    return responses;
+}
+
+std::vector<std::string> weather::GetWeatherBatch(IWeatherServer& server, const std::vector<std::string>& requests)
+{
+    IBatchWeatherServer* batchServer = dynamic_cast<IBatchWeatherServer*>(&server);
+    if (batchServer != nullptr)
+    {
+        std::vector<std::string> responses = batchServer->GetWeatherBatch(requests);
+        // Callers match responses to requests by index
+        if (responses.size() != requests.size())
+        {
+            throw std::runtime_error("server returned " + std::to_string(responses.size()) + " responses for " +
+                                     std::to_string(requests.size()) + " requests");
+        }
+        return responses;
+    }
+    return BatchWeatherServerAdapter(server).GetWeatherBatch(requests);
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include "ibatchweatherserver.h"
+
+// Lets a server which knows only single requests be used where a batch is expected.
+// Each request of a batch still takes its own round trip.
+class BatchWeatherServerAdapter : public IBatchWeatherServer
+{
+public:
+    explicit BatchWeatherServerAdapter(IWeatherServer& server);
+
+    std::string GetWeather(const std::string& request) override;
+    std::vector<std::string> GetWeatherBatch(const std::vector<std::string>& requests) override;
+
+private:
+    IWeatherServer& m_server;
+};
+
+namespace weather
+{
+    // One round trip if the server supports batches, a request per item otherwise.
+    // Throws std::runtime_error when the server doesn't answer every request.
+    std::vector<std::string> GetWeatherBatch(IWeatherServer& server, const std::vector<std::string>& requests);
+}
@@ -0,0 +1,352 @@
+// Performance checks for the weather client.
+// They are disabled by default, run them with --gtest_also_run_disabled_tests --gtest_filter=*Benchmark*
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include "weatherclient.h"
+#include "fakeweatherserver.h"
+#include "batchweatherserveradapter.h"
+#include "asyncweatherserver.h"
+#include "statskernels.h"
+#include "simulatedweatherserver.h"
+#include "cityweatheraggregator.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace
+{
+    // Typical for a server in the same region
+    const std::chrono::microseconds s_roundTripDelay(2000);
+    const std::vector<std::string> s_dates = { "31.08.2018", "01.09.2018", "02.09.2018" };
+
+    // Answers any request after the delay, so reports may span any dates
+    class SlowWeatherServer : public IWeatherServer
+    {
+    public:
+        std::string GetWeather(const std::string&) override
+        {
+            std::this_thread::sleep_for(s_roundTripDelay);
+            return "20;181;5.1";
+        }
+    };
+
+    std::vector<std::string> MakeMonth()
+    {
+        std::vector<std::string> dates;
+        for (int day = 1; day <= 30; ++day)
+        {
+            dates.push_back((day < 10 ? "0" : "") + std::to_string(day) + ".09.2018");
+        }
+        return dates;
+    }
+
+    // The way responses were parsed before DecodeResponse
+    Weather ParseWithStream(const std::string& response)
+    {
+        std::istringstream stream(response);
+        Weather weather;
+        char separator = 0;
+        stream >> weather.temperature >> separator >> weather.windDirection >> separator >> weather.windSpeed;
+        return weather;
+    }
+
+    template<typename Action>
+    double MeasureSeconds(Action action)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        action();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+TEST(WeatherClientBenchmark, DISABLED_BatchFetch)
+{
+    FakeWeatherServer server(s_roundTripDelay);
+    BatchWeatherServerAdapter singleRequests(server);
+    WeatherClient client;
+
+    double checksum = 0;
+    const double single = MeasureSeconds([&]()
+    {
+        for (const std::string& date : s_dates)
+        {
+            checksum += client.GetAverageTemperature(singleRequests, date);
+        }
+    });
+    const size_t singleRoundTrips = server.GetRoundTrips();
+
+    const double batchPerDate = MeasureSeconds([&]()
+    {
+        for (const std::string& date : s_dates)
+        {
+            checksum += client.GetAverageTemperature(server, date);
+        }
+    });
+    const size_t batchPerDateRoundTrips = server.GetRoundTrips() - singleRoundTrips;
+
+    const double batchRange = MeasureSeconds([&]()
+    {
+        for (const Weather& weather : weather::GetDaysWeather(server, s_dates))
+        {
+            checksum += weather.temperature / g_slotsPerDay;
+        }
+    });
+
+    EXPECT_DOUBLE_EQ(3 * (25.5 + 24 + 26.75), checksum);
+    EXPECT_EQ(s_dates.size() * g_slotsPerDay, singleRoundTrips);
+    EXPECT_EQ(s_dates.size(), batchPerDateRoundTrips);
+    std::cout << "single requests: " << single * 1000 / s_dates.size() << " ms/date" << std::endl;
+    std::cout << "batch per date: " << batchPerDate * 1000 / s_dates.size() << " ms/date, speedup "
+              << single / batchPerDate << std::endl;
+    std::cout << "batch for range: " << batchRange * 1000 / s_dates.size() << " ms/date, speedup "
+              << single / batchRange << std::endl;
+}
+
+TEST(WeatherClientBenchmark, DISABLED_AsyncMonthReport)
+{
+    SlowWeatherServer upstream;
+    const std::vector<std::string> month = MakeMonth();
+
+    const unsigned limits[] = { 1, 2, 4, 8, 16, 32 };
+    for (unsigned limit : limits)
+    {
+        AsyncWeatherServer server(upstream, limit);
+        std::vector<Weather> weather;
+        const double seconds = MeasureSeconds([&]() { weather = weather::GetDaysWeather(server, month); });
+        ASSERT_EQ(month.size() * g_slotsPerDay, weather.size());
+        std::cout << limit << " in flight: " << seconds * 1000 << " ms for " << month.size() << " days" << std::endl;
+    }
+}
+
+TEST(WeatherClientBenchmark, DISABLED_ResponseDecoding)
+{
+    const std::vector<std::string> responses = { "20;181;5.1", "-3;299;14.25", "33;0;0.4", "26;359;4.5" };
+    const size_t iterations = 4000000;
+
+    double streamSum = 0;
+    const double stream = MeasureSeconds([&]()
+    {
+        for (size_t i = 0; i < iterations; ++i)
+        {
+            streamSum += ParseWithStream(responses[i % responses.size()]).windSpeed;
+        }
+    });
+
+    double decodedSum = 0;
+    const double decoded = MeasureSeconds([&]()
+    {
+        Weather weather;
+        for (size_t i = 0; i < iterations; ++i)
+        {
+            if (weather::DecodeResponse(responses[i % responses.size()], weather) == weather::ResponseStatus::Ok)
+            {
+                decodedSum += weather.windSpeed;
+            }
+        }
+    });
+
+    EXPECT_NEAR(streamSum, decodedSum, 1e-6 * streamSum);
+    std::cout << "istringstream: " << iterations / stream << " responses/sec" << std::endl;
+    std::cout << "from_chars: " << iterations / decoded << " responses/sec, speedup " << stream / decoded << std::endl;
+}
+
+TEST(WeatherClientBenchmark, DISABLED_RequestKeys)
+{
+    const Timestamp first = weather::MakeTimestamp(weather::ParseDate("01.01.2000"), 0);
+    const Timestamp count = 4000000;
+
+    std::vector<std::string> requests;
+    requests.reserve(count);
+    const double encoded = MeasureSeconds([&]()
+    {
+        char request[g_requestLength];
+        for (Timestamp timestamp = first; timestamp < first + count; ++timestamp)
+        {
+            weather::EncodeRequest(timestamp, request);
+            requests.emplace_back(request, g_requestLength);
+        }
+    });
+
+    uint64_t sum = 0;
+    const double decoded = MeasureSeconds([&]()
+    {
+        for (const std::string& request : requests)
+        {
+            Timestamp timestamp = 0;
+            weather::DecodeRequest(request, timestamp);
+            sum += timestamp;
+        }
+    });
+
+    EXPECT_EQ((static_cast<uint64_t>(first) * 2 + count - 1) * count / 2, sum);
+    std::cout << "encoded: " << count / encoded << " requests/sec, decoded: " << count / decoded << " requests/sec" << std::endl;
+    std::cout << "key: " << sizeof(Timestamp) << " bytes, request: " << sizeof(std::string) + g_requestLength + 1 << " bytes" << std::endl;
+}
+
+TEST(WeatherClientBenchmark, DISABLED_StatsKernels)
+{
+    // Ten years of readings
+    const size_t samplesCount = 3652 * g_slotsPerDay;
+    const size_t repeats = 200;
+    std::vector<double> temperatures(samplesCount);
+    std::vector<double> directions(samplesCount);
+    for (size_t index = 0; index < samplesCount; ++index)
+    {
+        temperatures[index] = static_cast<double>(index * 37 % 50) - 10;
+        directions[index] = static_cast<double>(index * 7 % 360);
+    }
+
+    double naiveSum = 0;
+    const double naiveStats = MeasureSeconds([&]()
+    {
+        for (size_t repeat = 0; repeat < repeats; ++repeat)
+        {
+            double minimum = temperatures[0];
+            double maximum = temperatures[0];
+            double sum = 0;
+            for (double temperature : temperatures)
+            {
+                minimum = std::min(minimum, temperature);
+                maximum = std::max(maximum, temperature);
+                sum += temperature;
+            }
+            naiveSum += minimum + maximum + sum;
+        }
+    });
+    std::cout << "naive stats: " << samplesCount * repeats / naiveStats << " samples/sec" << std::endl;
+
+    const std::pair<weather::StatsKernel, const char*> kernels[] = {
+        { weather::StatsKernel::Scalar, "scalar" },
+        { weather::StatsKernel::Sse2, "sse2" },
+        { weather::StatsKernel::Avx2, "avx2" }
+    };
+    for (const auto& kernel : kernels)
+    {
+        if (!weather::IsStatsKernelSupported(kernel.first))
+        {
+            continue;
+        }
+        double kernelSum = 0;
+        const double seconds = MeasureSeconds([&]()
+        {
+            for (size_t repeat = 0; repeat < repeats; ++repeat)
+            {
+                const SampleStats stats = weather::ComputeStats(kernel.first, temperatures.data(), temperatures.size());
+                kernelSum += stats.minimum + stats.maximum + stats.sum;
+            }
+        });
+        EXPECT_NEAR(naiveSum, kernelSum, 1e-9 * std::abs(naiveSum));
+        std::cout << kernel.second << " stats: " << samplesCount * repeats / seconds << " samples/sec, speedup "
+                  << naiveStats / seconds << std::endl;
+    }
+
+    double scalar = 0;
+    for (const auto& kernel : kernels)
+    {
+        if (!weather::IsStatsKernelSupported(kernel.first))
+        {
+            std::cout << kernel.second << " directions: not supported" << std::endl;
+            continue;
+        }
+        double mean = 0;
+        const double seconds = MeasureSeconds([&]()
+        {
+            for (size_t repeat = 0; repeat < repeats; ++repeat)
+            {
+                const DirectionSums sums = weather::SumDirections(kernel.first, directions.data(), directions.size());
+                mean += weather::MeanDirection(sums.sin, sums.cos);
+            }
+        });
+        scalar = scalar == 0 ? seconds : scalar;
+        EXPECT_NE(0, mean);
+        std::cout << kernel.second << " directions: " << samplesCount * repeats / seconds << " samples/sec, speedup "
+                  << scalar / seconds << std::endl;
+    }
+}
+
+TEST(WeatherClientBenchmark, DISABLED_SimulatedYearReport)
+{
+    SteadyClock clock;
+    SimulatorSettings settings;
+    settings.latencyDistribution = LatencyDistribution::LogNormal;
+    settings.latency = std::chrono::microseconds(1000);
+    settings.latencySpread = 0.5;
+    SimulatedWeatherServer simulator(settings, clock);
+
+    // First four weeks of every month
+    std::vector<std::string> year;
+    for (int month = 1; month <= 12; ++month)
+    {
+        for (int day = 1; day <= 28; ++day)
+        {
+            year.push_back((day < 10 ? "0" : "") + std::to_string(day) + (month < 10 ? ".0" : ".") + std::to_string(month) + ".2018");
+        }
+    }
+
+    WeatherClient client;
+    double checksum = 0;
+    auto report = [&](IWeatherServer& server)
+    {
+        for (const std::string& date : year)
+        {
+            checksum += client.GetAverageTemperature(server, date);
+        }
+    };
+
+    BatchWeatherServerAdapter singleRequests(simulator);
+    const double single = MeasureSeconds([&]() { report(singleRequests); });
+    const double batchPerDate = MeasureSeconds([&]() { report(simulator); });
+    AsyncWeatherServer async(singleRequests, 16);
+    const double asyncPerDate = MeasureSeconds([&]() { report(async); });
+    const double range = MeasureSeconds([&]() { weather::GetDaysWeather(simulator, year); });
+    const double asyncRange = MeasureSeconds([&]() { weather::GetDaysWeather(async, year); });
+
+    EXPECT_NE(0, checksum);
+    std::cout << year.size() << " days, log-normal latency around 1 ms" << std::endl;
+    std::cout << "single requests: " << single * 1000 << " ms" << std::endl;
+    std::cout << "batch per date: " << batchPerDate * 1000 << " ms" << std::endl;
+    std::cout << "async per date, 16 in flight: " << asyncPerDate * 1000 << " ms" << std::endl;
+    std::cout << "batch for range: " << range * 1000 << " ms" << std::endl;
+    std::cout << "async for range, 16 in flight: " << asyncRange * 1000 << " ms" << std::endl;
+}
+
+TEST(WeatherClientBenchmark, DISABLED_CitiesReportScaling)
+{
+    const size_t citiesCount = 300;
+    std::vector<std::string> cities;
+    for (size_t city = 0; city < citiesCount; ++city)
+    {
+        cities.push_back("city" + std::to_string(city));
+    }
+    std::vector<std::string> year;
+    for (uint32_t day = weather::ParseDate("01.01.2018"); day < weather::ParseDate("01.01.2019"); ++day)
+    {
+        year.push_back(weather::FormatRequest(weather::MakeTimestamp(day, 0)).substr(0, 10));
+    }
+
+    // Servers answer at once, so the time goes to requests, responses and statistics
+    SteadyClock clock;
+    CityServerFactory simulators = [&clock](const std::string& city)
+    {
+        SimulatorSettings settings;
+        settings.seed = std::hash<std::string>()(city);
+        return std::unique_ptr<IWeatherServer>(new SimulatedWeatherServer(settings, clock));
+    };
+
+    const size_t readings = citiesCount * year.size() * g_slotsPerDay;
+    const unsigned maxShards = std::max(std::thread::hardware_concurrency(), 1u);
+    double single = 0;
+    for (unsigned shards = 1; shards <= maxShards; shards *= 2)
+    {
+        CityWeatherAggregator aggregator(simulators, clock, shards, std::chrono::hours(1), 1024 * 1024);
+        CitiesReport report;
+        const double cold = MeasureSeconds([&]() { report = aggregator.GetReport(cities, year); });
+        const double warm = MeasureSeconds([&]() { report = aggregator.GetReport(cities, year); });
+        ASSERT_EQ(readings, report.total.temperature.count);
+        single = shards == 1 ? cold : single;
+        std::cout << shards << " shards: " << readings / cold << " readings/sec, speedup " << single / cold
+                  << ", cached: " << readings / warm << " readings/sec" << std::endl;
+    }
+}
@@ -0,0 +1,160 @@
+#include "cachingweatherserver.h"
+#include "batchweatherserveradapter.h"
+#include <limits>
+
+namespace
+{
+    // Links of the list node, the hash node with its key, iterator and bucket, roughly
+    const size_t s_nodesOverhead = 5 * sizeof(void*) + sizeof(Timestamp);
+    // Far beyond the year 9999, so no request decodes to it
+    const Timestamp s_invalidTimestamp = std::numeric_limits<Timestamp>::max();
+}
+
+CachingWeatherServer::CachingWeatherServer(IWeatherServer& upstream, IClock& clock,
+                                           std::chrono::steady_clock::duration timeToLive, size_t memoryLimit)
+    : m_upstream(upstream)
+    , m_clock(clock)
+    , m_timeToLive(timeToLive)
+    , m_memoryLimit(memoryLimit)
+    , m_memoryUsage(0)
+    , m_hits(0)
+    , m_misses(0)
+{
+}
+
+std::string CachingWeatherServer::GetWeather(const std::string& request)
+{
+    const std::chrono::steady_clock::time_point now = m_clock.Now();
+
+    Timestamp timestamp = 0;
+    if (!weather::DecodeRequest(request, timestamp))
+    {
+        ++m_misses;
+        return m_upstream.GetWeather(request);
+    }
+    std::string response;
+    if (FindFresh(timestamp, now, response))
+    {
+        return response;
+    }
+    response = m_upstream.GetWeather(request);
+    Store(timestamp, response, now);
+    return response;
+}
+
+std::vector<std::string> CachingWeatherServer::GetWeatherBatch(const std::vector<std::string>& requests)
+{
+    const std::chrono::steady_clock::time_point now = m_clock.Now();
+
+    std::vector<std::string> responses(requests.size());
+    std::vector<size_t> missed;
+    std::vector<Timestamp> missedTimestamps;
+    std::vector<std::string> missedRequests;
+    for (size_t index = 0; index < requests.size(); ++index)
+    {
+        Timestamp timestamp = 0;
+        const bool valid = weather::DecodeRequest(requests[index], timestamp);
+        if (valid && FindFresh(timestamp, now, responses[index]))
+        {
+            continue;
+        }
+        if (!valid)
+        {
+            ++m_misses;
+        }
+        missed.push_back(index);
+        missedTimestamps.push_back(valid ? timestamp : s_invalidTimestamp);
+        missedRequests.push_back(requests[index]);
+    }
+    if (missed.empty())
+    {
+        return responses;
+    }
+
+    // All misses go upstream in one round trip
+    std::vector<std::string> fetched = weather::GetWeatherBatch(m_upstream, missedRequests);
+    for (size_t index = 0; index < missed.size(); ++index)
+    {
+        if (missedTimestamps[index] != s_invalidTimestamp)
+        {
+            Store(missedTimestamps[index], fetched[index], now);
+        }
+        responses[missed[index]] = std::move(fetched[index]);
+    }
+    return responses;
+}
+
+size_t CachingWeatherServer::GetHits() const
+{
+    return m_hits;
+}
+
+size_t CachingWeatherServer::GetMisses() const
+{
+    return m_misses;
+}
+
+size_t CachingWeatherServer::GetMemoryUsage() const
+{
+    return m_memoryUsage;
+}
+
+size_t CachingWeatherServer::GetSize() const
+{
+    return m_entries.size();
+}
+
+size_t CachingWeatherServer::GetEntrySize(const Entry& entry)
+{
+    return sizeof(Entry) + s_nodesOverhead + entry.response.size();
+}
+
+bool CachingWeatherServer::FindFresh(Timestamp timestamp, std::chrono::steady_clock::time_point now,
+                                     std::string& response)
+{
+    auto found = m_index.find(timestamp);
+    if (found != m_index.end())
+    {
+        if (found->second->expires > now)
+        {
+            ++m_hits;
+            m_entries.splice(m_entries.begin(), m_entries, found->second);
+            response = found->second->response;
+            return true;
+        }
+        Erase(found->second);
+    }
+    ++m_misses;
+    return false;
+}
+
+void CachingWeatherServer::Store(Timestamp timestamp, const std::string& response,
+                                 std::chrono::steady_clock::time_point now)
+{
+    if (response.empty() || m_index.count(timestamp) != 0)
+    {
+        return;
+    }
+
+    Entry entry = { timestamp, response, now + m_timeToLive };
+    const size_t entrySize = GetEntrySize(entry);
+    if (entrySize > m_memoryLimit)
+    {
+        return;
+    }
+    while (m_memoryUsage + entrySize > m_memoryLimit)
+    {
+        Erase(std::prev(m_entries.end()));
+    }
+
+    m_entries.push_front(std::move(entry));
+    m_index[timestamp] = m_entries.begin();
+    m_memoryUsage += entrySize;
+}
+
+void CachingWeatherServer::Erase(Entries::iterator entry)
+{
+    m_memoryUsage -= GetEntrySize(*entry);
+    m_index.erase(entry->timestamp);
+    m_entries.erase(entry);
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include "ibatchweatherserver.h"
+#include "iclock.h"
+#include "weather.h"
+#include <list>
+#include <unordered_map>
+
+/*
+ * Remembers responses of another server by the timestamp of their request.
+ * A response is served from memory until its time to live expires.
+ * When the responses take more memory than allowed, the least recently used ones are dropped.
+ * Requests which are not a valid date and time and empty responses are passed through and never stored.
+ * Misses of a batch are fetched from the upstream server in one batch as well.
+ */
+class CachingWeatherServer : public IBatchWeatherServer
+{
+public:
+    CachingWeatherServer(IWeatherServer& upstream, IClock& clock,
+                         std::chrono::steady_clock::duration timeToLive, size_t memoryLimit);
+
+    std::string GetWeather(const std::string& request) override;
+    std::vector<std::string> GetWeatherBatch(const std::vector<std::string>& requests) override;
+
+    size_t GetHits() const;
+    size_t GetMisses() const;
+    // Approximate memory taken by the stored responses
+    size_t GetMemoryUsage() const;
+    size_t GetSize() const;
+
+private:
+    struct Entry
+    {
+        Timestamp timestamp;
+        std::string response;
+        std::chrono::steady_clock::time_point expires;
+    };
+    typedef std::list<Entry> Entries;
+
+    static size_t GetEntrySize(const Entry& entry);
+    // Counts a hit or a miss, drops the entry if it has expired
+    bool FindFresh(Timestamp timestamp, std::chrono::steady_clock::time_point now, std::string& response);
+    void Store(Timestamp timestamp, const std::string& response, std::chrono::steady_clock::time_point now);
+    void Erase(Entries::iterator entry);
+
+    IWeatherServer& m_upstream;
+    IClock& m_clock;
+    std::chrono::steady_clock::duration m_timeToLive;
+    size_t m_memoryLimit;
+    size_t m_memoryUsage;
+    size_t m_hits;
+    size_t m_misses;
+    // Most recently used first
+    Entries m_entries;
+    std::unordered_map<Timestamp, Entries::iterator> m_index;
+};
@@ -0,0 +1,165 @@
+#include "cityweatheraggregator.h"
+#include "weatherclient.h"
+#include <algorithm>
+
+namespace
+{
+    CityWeather Summarize(IWeatherServer& server, const std::vector<Timestamp>& timestamps)
+    {
+        const std::vector<Weather> readings = weather::GetReadings(server, timestamps);
+        std::vector<double> column(readings.size());
+
+        CityWeather summary;
+        std::transform(readings.begin(), readings.end(), column.begin(), [](const Weather& w) { return w.temperature; });
+        summary.temperature = weather::ComputeStats(column.data(), column.size());
+        std::transform(readings.begin(), readings.end(), column.begin(), [](const Weather& w) { return w.windSpeed; });
+        summary.windSpeed = weather::ComputeStats(column.data(), column.size());
+        std::transform(readings.begin(), readings.end(), column.begin(), [](const Weather& w) { return w.windDirection; });
+        summary.windDirection = weather::SumDirections(column.data(), column.size());
+        return summary;
+    }
+}
+
+CityWeatherAggregator::CityWeatherAggregator(CityServerFactory serverFactory, IClock& clock, unsigned shardsCount,
+                                             std::chrono::steady_clock::duration timeToLive, size_t memoryLimitPerCity)
+    : m_serverFactory(std::move(serverFactory))
+    , m_clock(clock)
+    , m_timeToLive(timeToLive)
+    , m_memoryLimitPerCity(memoryLimitPerCity)
+{
+    const unsigned count = std::max(shardsCount, 1u);
+    m_shards.reserve(count);
+    for (unsigned i = 0; i < count; ++i)
+    {
+        m_shards.push_back(std::make_unique<Shard>());
+        Shard& shard = *m_shards.back();
+        shard.worker = std::thread(&CityWeatherAggregator::Work, this, std::ref(shard));
+    }
+}
+
+CityWeatherAggregator::~CityWeatherAggregator()
+{
+    for (const std::unique_ptr<Shard>& shard : m_shards)
+    {
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            shard->stopping = true;
+        }
+        shard->tasksReady.notify_one();
+    }
+    for (const std::unique_ptr<Shard>& shard : m_shards)
+    {
+        shard->worker.join();
+    }
+}
+
+CitiesReport CityWeatherAggregator::GetReport(const std::vector<std::string>& cities,
+                                              const std::vector<std::string>& dates)
+{
+    const std::vector<Timestamp> timestamps = weather::MakeDaysTimestamps(dates);
+
+    std::vector<std::vector<size_t>> shardCities(m_shards.size());
+    for (size_t index = 0; index < cities.size(); ++index)
+    {
+        shardCities[GetShardOf(cities[index])].push_back(index);
+    }
+
+    // Every shard writes only the cities it owns and its own partial total
+    CitiesReport report = { std::vector<CityWeather>(cities.size()), CityWeather() };
+    std::vector<CityWeather> partials(m_shards.size());
+    std::vector<std::future<void>> pending;
+    for (size_t index = 0; index < m_shards.size(); ++index)
+    {
+        if (shardCities[index].empty())
+        {
+            continue;
+        }
+
+        Shard& shard = *m_shards[index];
+        const std::vector<size_t>& owned = shardCities[index];
+        CityWeather& partial = partials[index];
+        std::packaged_task<void()> task([this, &shard, &owned, &partial, &cities, &timestamps, &report]()
+        {
+            // Summed locally, the partials of the shards share cache lines
+            CityWeather total = CityWeather();
+            for (size_t city : owned)
+            {
+                report.cities[city] = Summarize(GetCityServer(shard, cities[city]), timestamps);
+                weather::MergeCityWeather(total, report.cities[city]);
+            }
+            partial = total;
+        });
+        pending.push_back(task.get_future());
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.tasks.push_back(std::move(task));
+        }
+        shard.tasksReady.notify_one();
+    }
+
+    // Wait for all shards before rethrowing, they refer to the locals of this call
+    for (std::future<void>& done : pending)
+    {
+        done.wait();
+    }
+    for (std::future<void>& done : pending)
+    {
+        done.get();
+    }
+    for (const CityWeather& partial : partials)
+    {
+        weather::MergeCityWeather(report.total, partial);
+    }
+    return report;
+}
+
+unsigned CityWeatherAggregator::GetShardsCount() const
+{
+    return static_cast<unsigned>(m_shards.size());
+}
+
+unsigned CityWeatherAggregator::GetShardOf(const std::string& city) const
+{
+    return static_cast<unsigned>(std::hash<std::string>()(city) % m_shards.size());
+}
+
+void CityWeatherAggregator::Work(Shard& shard)
+{
+    for (;;)
+    {
+        std::packaged_task<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(shard.mutex);
+            shard.tasksReady.wait(lock, [&shard]() { return shard.stopping || !shard.tasks.empty(); });
+            if (shard.tasks.empty())
+            {
+                return;
+            }
+            task = std::move(shard.tasks.front());
+            shard.tasks.pop_front();
+        }
+        task();
+    }
+}
+
+IWeatherServer& CityWeatherAggregator::GetCityServer(Shard& shard, const std::string& city)
+{
+    auto found = shard.cities.find(city);
+    if (found == shard.cities.end())
+    {
+        City created;
+        created.server = m_serverFactory(city);
+        created.cache = std::make_unique<CachingWeatherServer>(*created.server, m_clock, m_timeToLive,
+                                                               m_memoryLimitPerCity);
+        found = shard.cities.emplace(city, std::move(created)).first;
+    }
+    return *found->second.cache;
+}
+
+void weather::MergeCityWeather(CityWeather& weather, const CityWeather& other)
+{
+    MergeStats(weather.temperature, other.temperature);
+    MergeStats(weather.windSpeed, other.windSpeed);
+    weather.windDirection.sin += other.windDirection.sin;
+    weather.windDirection.cos += other.windDirection.cos;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include "iweatherserver.h"
+#include "iclock.h"
+#include "cachingweatherserver.h"
+#include "statskernels.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+// Statistics of the readings of a city, or of several cities merged
+struct CityWeather
+{
+    SampleStats temperature;
+    SampleStats windSpeed;
+    DirectionSums windDirection;
+};
+
+struct CitiesReport
+{
+    // In the order of the queried cities
+    std::vector<CityWeather> cities;
+    // All readings of all the cities
+    CityWeather total;
+};
+
+// Server of the city, it is called only from the thread of the shard which owns the city
+typedef std::function<std::unique_ptr<IWeatherServer>(const std::string& city)> CityServerFactory;
+
+/*
+ * Answers bulk queries over many cities ("maximum temperature of these 300 cities over this week").
+ * Cities are spread over shards by the hash of their name. Every shard has its own worker thread
+ * and its own servers and caches of its cities, so nothing is shared while readings are fetched
+ * and summed up. The caller only waits for the partial reports of the shards and merges them.
+ */
+class CityWeatherAggregator
+{
+public:
+    CityWeatherAggregator(CityServerFactory serverFactory, IClock& clock, unsigned shardsCount,
+                          std::chrono::steady_clock::duration timeToLive, size_t memoryLimitPerCity);
+    ~CityWeatherAggregator();
+
+    CityWeatherAggregator(const CityWeatherAggregator&) = delete;
+    CityWeatherAggregator& operator=(const CityWeatherAggregator&) = delete;
+
+    // Throws std::runtime_error for an invalid date and rethrows errors of the servers
+    CitiesReport GetReport(const std::vector<std::string>& cities, const std::vector<std::string>& dates);
+
+    unsigned GetShardsCount() const;
+    unsigned GetShardOf(const std::string& city) const;
+
+private:
+    struct City
+    {
+        std::unique_ptr<IWeatherServer> server;
+        std::unique_ptr<CachingWeatherServer> cache;
+    };
+
+    struct Shard
+    {
+        std::mutex mutex;
+        std::condition_variable tasksReady;
+        std::deque<std::packaged_task<void()>> tasks;
+        bool stopping = false;
+        // Touched by the worker only
+        std::unordered_map<std::string, City> cities;
+        std::thread worker;
+    };
+
+    void Work(Shard& shard);
+    IWeatherServer& GetCityServer(Shard& shard, const std::string& city);
+
+    CityServerFactory m_serverFactory;
+    IClock& m_clock;
+    std::chrono::steady_clock::duration m_timeToLive;
+    size_t m_memoryLimitPerCity;
+    std::vector<std::unique_ptr<Shard>> m_shards;
+};
+
+namespace weather
+{
+    void MergeCityWeather(CityWeather& weather, const CityWeather& other);
+}
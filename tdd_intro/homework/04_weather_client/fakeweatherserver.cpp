@@ -0,0 +1,62 @@
+#include "fakeweatherserver.h"
+#include <thread>
+
+FakeWeatherServer::FakeWeatherServer(std::chrono::microseconds roundTripDelay)
+    : m_responses({
+        { "31.08.2018;03:00", "20;181;5.1" },
+        { "31.08.2018;09:00", "23;204;4.9" },
+        { "31.08.2018;15:00", "33;193;4.3" },
+        { "31.08.2018;21:00", "26;179;4.5" },
+
+        { "01.09.2018;03:00", "19;176;4.2" },
+        { "01.09.2018;09:00", "22;131;4.1" },
+        { "01.09.2018;15:00", "31;109;4.0" },
+        { "01.09.2018;21:00", "24;127;4.1" },
+
+        { "02.09.2018;03:00", "21;158;3.8" },
+        { "02.09.2018;09:00", "25;201;3.5" },
+        { "02.09.2018;15:00", "34;258;3.7" },
+        { "02.09.2018;21:00", "27;299;4.0" }
+    })
+    , m_roundTripDelay(roundTripDelay)
+    , m_roundTrips(0)
+{
+}
+
+std::string FakeWeatherServer::GetWeather(const std::string& request)
+{
+    RoundTrip();
+    return FindResponse(request);
+}
+
+std::vector<std::string> FakeWeatherServer::GetWeatherBatch(const std::vector<std::string>& requests)
+{
+    RoundTrip();
+    std::vector<std::string> responses;
+    responses.reserve(requests.size());
+    for (const std::string& request : requests)
+    {
+        responses.push_back(FindResponse(request));
+    }
+    return responses;
+}
+
+size_t FakeWeatherServer::GetRoundTrips() const
+{
+    return m_roundTrips;
+}
+
+void FakeWeatherServer::RoundTrip()
+{
+    ++m_roundTrips;
+    if (m_roundTripDelay != std::chrono::microseconds::zero())
+    {
+        std::this_thread::sleep_for(m_roundTripDelay);
+    }
+}
+
+std::string FakeWeatherServer::FindResponse(const std::string& request) const
+{
+    auto response = m_responses.find(request);
+    return response == m_responses.end() ? std::string() : response->second;
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include "ibatchweatherserver.h"
+#include <atomic>
+#include <chrono>
+#include <map>
+
+// Answers with the responses recorded from the real server.
+// Every round trip, single or batch, may be slowed down to look like a remote server.
+// Calls from several threads are allowed.
+class FakeWeatherServer : public IBatchWeatherServer
+{
+public:
+    explicit FakeWeatherServer(std::chrono::microseconds roundTripDelay = std::chrono::microseconds::zero());
+
+    std::string GetWeather(const std::string& request) override;
+    std::vector<std::string> GetWeatherBatch(const std::vector<std::string>& requests) override;
+
+    size_t GetRoundTrips() const;
+
+private:
+    void RoundTrip();
+    std::string FindResponse(const std::string& request) const;
+
+    std::map<std::string, std::string> m_responses;
+    std::chrono::microseconds m_roundTripDelay;
+    std::atomic<size_t> m_roundTrips;
+};
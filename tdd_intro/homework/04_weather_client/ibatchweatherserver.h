@@ -0,0 +1,11 @@
+#pragma once
+#include "iweatherserver.h"
+#include <vector>
+
+// Server which answers many requests in a single round trip
+class IBatchWeatherServer : public IWeatherServer
+{
+public:
+    // Responses in the order of requests, empty ones for invalid requests
+    virtual std::vector<std::string> GetWeatherBatch(const std::vector<std::string>& requests) = 0;
+};
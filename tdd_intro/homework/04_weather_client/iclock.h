@@ -0,0 +1,19 @@
+#pragma once
+#include <chrono>
+
+// Source of the current time, so that expiration can be tested without waiting
+class IClock
+{
+public:
+    virtual ~IClock() { }
+    virtual std::chrono::steady_clock::time_point Now() = 0;
+};
+
+class SteadyClock : public IClock
+{
+public:
+    std::chrono::steady_clock::time_point Now() override
+    {
+        return std::chrono::steady_clock::now();
+    }
+};
@@ -0,0 +1,23 @@
+#pragma once
+#include <gmock/gmock.h>
+#include "ibatchweatherserver.h"
+#include "iclock.h"
+
+class WeatherServerMock : public IWeatherServer
+{
+public:
+    MOCK_METHOD1(GetWeather, std::string(const std::string& request));
+};
+
+class BatchWeatherServerMock : public IBatchWeatherServer
+{
+public:
+    MOCK_METHOD1(GetWeather, std::string(const std::string& request));
+    MOCK_METHOD1(GetWeatherBatch, std::vector<std::string>(const std::vector<std::string>& requests));
+};
+
+class ClockMock : public IClock
+{
+public:
+    MOCK_METHOD0(Now, std::chrono::steady_clock::time_point());
+};
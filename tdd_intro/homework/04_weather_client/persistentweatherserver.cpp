@@ -0,0 +1,76 @@
+#include "persistentweatherserver.h"
+#include "batchweatherserveradapter.h"
+
+PersistentWeatherServer::PersistentWeatherServer(IWeatherServer& upstream, WeatherFile& file)
+    : m_upstream(upstream)
+    , m_file(file)
+{
+}
+
+std::string PersistentWeatherServer::GetWeather(const std::string& request)
+{
+    std::string response;
+    if (FindInFile(request, response))
+    {
+        return response;
+    }
+    response = m_upstream.GetWeather(request);
+    AddToFile(request, response);
+    return response;
+}
+
+std::vector<std::string> PersistentWeatherServer::GetWeatherBatch(const std::vector<std::string>& requests)
+{
+    std::vector<std::string> responses(requests.size());
+    std::vector<size_t> missed;
+    std::vector<std::string> missedRequests;
+    for (size_t index = 0; index < requests.size(); ++index)
+    {
+        if (!FindInFile(requests[index], responses[index]))
+        {
+            missed.push_back(index);
+            missedRequests.push_back(requests[index]);
+        }
+    }
+    if (missed.empty())
+    {
+        return responses;
+    }
+
+    std::vector<std::string> fetched = weather::GetWeatherBatch(m_upstream, missedRequests);
+    for (size_t index = 0; index < missed.size(); ++index)
+    {
+        AddToFile(missedRequests[index], fetched[index]);
+        responses[missed[index]] = std::move(fetched[index]);
+    }
+    return responses;
+}
+
+bool PersistentWeatherServer::FindInFile(const std::string& request, std::string& response)
+{
+    Timestamp timestamp = 0;
+    if (!weather::DecodeRequest(request, timestamp))
+    {
+        return false;
+    }
+
+    Weather weather;
+    // A reader may miss readings which the writer has put into a grown copy of the file
+    if (m_file.Find(timestamp, weather) || (!m_file.IsWritable() && m_file.Refresh() && m_file.Find(timestamp, weather)))
+    {
+        response = weather::FormatResponse(weather);
+        return true;
+    }
+    return false;
+}
+
+void PersistentWeatherServer::AddToFile(const std::string& request, const std::string& response)
+{
+    Timestamp timestamp = 0;
+    Weather weather;
+    if (m_file.IsWritable() && weather::DecodeRequest(request, timestamp) &&
+        weather::DecodeResponse(response, weather) == weather::ResponseStatus::Ok)
+    {
+        m_file.Append(timestamp, weather);
+    }
+}
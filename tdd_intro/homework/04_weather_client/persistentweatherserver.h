@@ -0,0 +1,24 @@
+#pragma once
+#include "ibatchweatherserver.h"
+#include "weatherfile.h"
+
+/*
+ * Answers requests from a weather file and asks another server only for readings the file lacks.
+ * Readings from the other server are added to the file when it is writable,
+ * so the next run of the client starts with the whole history it has seen.
+ */
+class PersistentWeatherServer : public IBatchWeatherServer
+{
+public:
+    PersistentWeatherServer(IWeatherServer& upstream, WeatherFile& file);
+
+    std::string GetWeather(const std::string& request) override;
+    std::vector<std::string> GetWeatherBatch(const std::vector<std::string>& requests) override;
+
+private:
+    bool FindInFile(const std::string& request, std::string& response);
+    void AddToFile(const std::string& request, const std::string& response);
+
+    IWeatherServer& m_upstream;
+    WeatherFile& m_file;
+};
@@ -0,0 +1,136 @@
+#include "simulatedweatherserver.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace
+{
+    const double s_pi = 3.14159265358979323846;
+    const double s_daysInYear = 365.2425;
+    // 01.01.1970 is the first day of a year, so years start every s_daysInYear days from it
+    const double s_coldestDayOfYear = 15;
+    const double s_meanTemperature = 12;
+    const double s_seasonalSwing = 10;
+    const double s_slotTemperatures[g_slotsPerDay] = { -4, 0, 5, 1 };
+    const double s_maxWindSpeed = 9;
+
+    // splitmix64 finalizer, turns neighbouring inputs into unrelated outputs
+    uint64_t Mix(uint64_t value)
+    {
+        value += 0x9E3779B97F4A7C15ull;
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+        return value ^ (value >> 31);
+    }
+
+    // Uniform in [0, 1), the same for the same arguments
+    double Noise(uint64_t seed, uint64_t key, uint64_t field)
+    {
+        return static_cast<double>(Mix(Mix(seed ^ Mix(key)) + field) >> 11) / static_cast<double>(1ull << 53);
+    }
+
+    double RoundTo(double value, double step)
+    {
+        return std::round(value / step) * step;
+    }
+}
+
+SimulatedWeatherServer::SimulatedWeatherServer(const SimulatorSettings& settings, IClock& clock)
+    : m_settings(settings)
+    , m_clock(clock)
+    , m_random(settings.seed)
+    , m_tokens(settings.rateLimitBurst)
+    , m_lastRefill(clock.Now())
+{
+}
+
+std::string SimulatedWeatherServer::GetWeather(const std::string& request)
+{
+    const std::chrono::microseconds latency = StartRoundTrip();
+    std::this_thread::sleep_for(latency);
+    return Answer(request);
+}
+
+std::vector<std::string> SimulatedWeatherServer::GetWeatherBatch(const std::vector<std::string>& requests)
+{
+    const std::chrono::microseconds latency = StartRoundTrip();
+    std::this_thread::sleep_for(latency);
+
+    std::vector<std::string> responses;
+    responses.reserve(requests.size());
+    for (const std::string& request : requests)
+    {
+        responses.push_back(Answer(request));
+    }
+    return responses;
+}
+
+Weather SimulatedWeatherServer::GetReading(Timestamp timestamp) const
+{
+    const uint64_t seed = m_settings.seed;
+    const uint32_t day = timestamp / g_slotsPerDay;
+    const unsigned short slot = timestamp % g_slotsPerDay;
+
+    const double season = std::cos(2 * s_pi * (std::fmod(day, s_daysInYear) - s_coldestDayOfYear) / s_daysInYear);
+    const double dayWarmth = (Noise(seed, day, 0) - 0.5) * 6;
+    const double slotWarmth = (Noise(seed, timestamp, 1) - 0.5) * 3;
+    const double dayDirection = Noise(seed, day, 2) * 360;
+    const double slotTurn = (Noise(seed, timestamp, 3) - 0.5) * 60;
+    const double daySpeed = Noise(seed, day, 4);
+    const double slotGust = Noise(seed, timestamp, 5);
+
+    Weather weather;
+    weather.temperature = std::round(s_meanTemperature - s_seasonalSwing * season + s_slotTemperatures[slot] + dayWarmth + slotWarmth);
+    weather.windDirection = std::fmod(std::round(dayDirection + slotTurn) + 360, 360);
+    weather.windSpeed = RoundTo(s_maxWindSpeed * (0.1 + 0.6 * daySpeed + 0.3 * slotGust), 0.1);
+    return weather;
+}
+
+std::chrono::microseconds SimulatedWeatherServer::StartRoundTrip()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_settings.rateLimit > 0)
+    {
+        const std::chrono::steady_clock::time_point now = m_clock.Now();
+        const double elapsed = std::chrono::duration<double>(now - m_lastRefill).count();
+        m_tokens = std::min<double>(m_settings.rateLimitBurst, m_tokens + elapsed * m_settings.rateLimit);
+        m_lastRefill = now;
+        if (m_tokens < 1)
+        {
+            throw RateLimitExceeded();
+        }
+        m_tokens -= 1;
+    }
+
+    const double latency = static_cast<double>(m_settings.latency.count());
+    switch (m_settings.latencyDistribution)
+    {
+    case LatencyDistribution::Uniform:
+        return std::chrono::microseconds(static_cast<long long>(std::uniform_real_distribution<double>(
+                    latency * (1 - m_settings.latencySpread), latency * (1 + m_settings.latencySpread))(m_random)));
+    case LatencyDistribution::LogNormal:
+        return std::chrono::microseconds(static_cast<long long>(std::lognormal_distribution<double>(
+                    std::log(std::max(latency, 1.0)), m_settings.latencySpread)(m_random)));
+    default:
+        return m_settings.latency;
+    }
+}
+
+std::string SimulatedWeatherServer::Answer(const std::string& request)
+{
+    Timestamp timestamp = 0;
+    if (!weather::DecodeRequest(request, timestamp) ||
+        timestamp / g_slotsPerDay < m_settings.firstDay || timestamp / g_slotsPerDay > m_settings.lastDay)
+    {
+        return std::string();
+    }
+    if (m_settings.failureRate > 0)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (std::uniform_real_distribution<double>(0, 1)(m_random) < m_settings.failureRate)
+        {
+            return std::string();
+        }
+    }
+    return weather::FormatResponse(GetReading(timestamp));
+}
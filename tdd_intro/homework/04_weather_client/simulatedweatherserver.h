@@ -0,0 +1,72 @@
+#pragma once
+#include "ibatchweatherserver.h"
+#include "iclock.h"
+#include "weather.h"
+#include <mutex>
+#include <random>
+#include <stdexcept>
+
+enum class LatencyDistribution
+{
+    Fixed,      // always latency
+    Uniform,    // latency * (1 +- latencySpread)
+    LogNormal   // median latency, latencySpread is sigma of the logarithm
+};
+
+struct SimulatorSettings
+{
+    uint64_t seed = 1;
+    // Dates with readings, days since 01.01.1970, 01.01.2015 to 31.12.2019 by default
+    uint32_t firstDay = 16436;
+    uint32_t lastDay = 18261;
+
+    LatencyDistribution latencyDistribution = LatencyDistribution::Fixed;
+    std::chrono::microseconds latency = std::chrono::microseconds::zero();
+    double latencySpread = 0;
+
+    // Share of valid requests answered with an empty response, as if the server lost them
+    double failureRate = 0;
+
+    // Round trips per second allowed on average with bursts of up to rateLimitBurst, 0 for no limit
+    double rateLimit = 0;
+    unsigned rateLimitBurst = 1;
+};
+
+class RateLimitExceeded : public std::runtime_error
+{
+public:
+    RateLimitExceeded() : std::runtime_error("rate limit exceeded") { }
+};
+
+/*
+ * Server which makes up readings instead of looking them up.
+ * A reading depends only on the seed and the date and time: temperatures follow seasons
+ * and times of day, wind keeps its direction over a day. Latency, failures and rate limiting
+ * come from a generator seeded the same way, so runs repeat as long as requests come in the same order.
+ * Calls from several threads are allowed.
+ */
+class SimulatedWeatherServer : public IBatchWeatherServer
+{
+public:
+    SimulatedWeatherServer(const SimulatorSettings& settings, IClock& clock);
+
+    // Throws RateLimitExceeded when the client goes faster than the limit
+    std::string GetWeather(const std::string& request) override;
+    // Takes one round trip and counts as one request for the rate limit
+    std::vector<std::string> GetWeatherBatch(const std::vector<std::string>& requests) override;
+
+    // Reading for the timestamp, the same one the server answers with
+    Weather GetReading(Timestamp timestamp) const;
+
+private:
+    // Takes a token of the rate limit and picks latency of the round trip
+    std::chrono::microseconds StartRoundTrip();
+    std::string Answer(const std::string& request);
+
+    SimulatorSettings m_settings;
+    IClock& m_clock;
+    std::mutex m_mutex;
+    std::mt19937_64 m_random;
+    double m_tokens;
+    std::chrono::steady_clock::time_point m_lastRefill;
+};
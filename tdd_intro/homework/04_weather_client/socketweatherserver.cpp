@@ -0,0 +1,252 @@
+#include "socketweatherserver.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define WEATHER_HAS_UNIX_SOCKETS
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace
+{
+    const char s_errorMark = '!';
+    const size_t s_receiveSize = 4096;
+
+#ifdef WEATHER_HAS_UNIX_SOCKETS
+    sockaddr_un MakeAddress(const std::string& path)
+    {
+        sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path))
+        {
+            throw std::runtime_error("socket path is too long: " + path);
+        }
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        return address;
+    }
+
+    bool SendAll(int fd, const std::string& data)
+    {
+        size_t sent = 0;
+        while (sent < data.size())
+        {
+            const ssize_t result = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (result <= 0)
+            {
+                return false;
+            }
+            sent += static_cast<size_t>(result);
+        }
+        return true;
+    }
+
+    // Moves the next line out of buffer, reading more from fd when needed. False when the peer is gone.
+    bool ReceiveLine(int fd, std::string& buffer, std::string& line)
+    {
+        size_t end = buffer.find('\n');
+        while (end == std::string::npos)
+        {
+            char chunk[s_receiveSize];
+            const ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+            if (received <= 0)
+            {
+                return false;
+            }
+            buffer.append(chunk, static_cast<size_t>(received));
+            end = buffer.find('\n');
+        }
+        line.assign(buffer, 0, end);
+        buffer.erase(0, end + 1);
+        return true;
+    }
+#endif
+}
+
+#ifdef WEATHER_HAS_UNIX_SOCKETS
+WeatherSocketListener::WeatherSocketListener(IWeatherServer& server, const std::string& path)
+    : m_server(server)
+    , m_path(path)
+    , m_listenFd(socket(AF_UNIX, SOCK_STREAM, 0))
+    , m_stopping(false)
+{
+    const sockaddr_un address = MakeAddress(path);
+    unlink(path.c_str());
+    if (m_listenFd < 0 ||
+        bind(m_listenFd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(m_listenFd, SOMAXCONN) != 0)
+    {
+        if (m_listenFd >= 0)
+        {
+            close(m_listenFd);
+        }
+        throw std::runtime_error("can't listen at " + path);
+    }
+    m_acceptor = std::thread(&WeatherSocketListener::Accept, this);
+}
+
+WeatherSocketListener::~WeatherSocketListener()
+{
+    m_stopping = true;
+    // Wakes up accept and all reads of connections
+    shutdown(m_listenFd, SHUT_RDWR);
+    m_acceptor.join();
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (const Connection& connection : m_connections)
+        {
+            shutdown(connection.fd, SHUT_RDWR);
+        }
+        m_connectionClosed.wait(lock, [this]() { return m_connections.empty(); });
+    }
+    for (std::thread& worker : m_finished)
+    {
+        worker.join();
+    }
+    close(m_listenFd);
+    unlink(m_path.c_str());
+}
+
+void WeatherSocketListener::Accept()
+{
+    while (!m_stopping)
+    {
+        const int connection = accept(m_listenFd, nullptr, nullptr);
+        if (connection < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+            {
+                continue;
+            }
+            break;
+        }
+
+        std::vector<std::thread> finished;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_stopping)
+            {
+                close(connection);
+                break;
+            }
+            finished.swap(m_finished);
+            m_connections.push_back({ connection, std::thread(&WeatherSocketListener::Serve, this, connection) });
+        }
+        for (std::thread& worker : finished)
+        {
+            worker.join();
+        }
+    }
+}
+
+void WeatherSocketListener::Serve(int connection)
+{
+    std::string buffer;
+    std::string request;
+    while (ReceiveLine(connection, buffer, request))
+    {
+        std::string response;
+        try
+        {
+            std::lock_guard<std::mutex> lock(m_serverMutex);
+            response = m_server.GetWeather(request);
+        }
+        catch (const std::exception& error)
+        {
+            response = s_errorMark + std::string(error.what());
+        }
+        if (!SendAll(connection, response + '\n'))
+        {
+            break;
+        }
+    }
+
+    // The descriptor is closed right away, the thread can't join itself
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto closed = std::find_if(m_connections.begin(), m_connections.end(),
+                                         [connection](const Connection& item) { return item.fd == connection; });
+        close(connection);
+        m_finished.push_back(std::move(closed->worker));
+        m_connections.erase(closed);
+    }
+    m_connectionClosed.notify_all();
+}
+
+SocketWeatherServer::SocketWeatherServer(const std::string& path)
+    : m_fd(socket(AF_UNIX, SOCK_STREAM, 0))
+{
+    const sockaddr_un address = MakeAddress(path);
+    if (m_fd < 0 || connect(m_fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+    {
+        if (m_fd >= 0)
+        {
+            close(m_fd);
+        }
+        throw std::runtime_error("can't connect to " + path);
+    }
+}
+
+SocketWeatherServer::~SocketWeatherServer()
+{
+    close(m_fd);
+}
+
+std::string SocketWeatherServer::GetWeather(const std::string& request)
+{
+    std::string response;
+    if (!SendAll(m_fd, request + '\n') || !ReceiveLine(m_fd, m_received, response))
+    {
+        throw std::runtime_error("connection to the weather server is lost");
+    }
+    if (!response.empty() && response[0] == s_errorMark)
+    {
+        throw std::runtime_error(response.substr(1));
+    }
+    return response;
+}
+#else
+WeatherSocketListener::WeatherSocketListener(IWeatherServer& server, const std::string& path)
+    : m_server(server)
+    , m_path(path)
+    , m_listenFd(-1)
+    , m_stopping(false)
+{
+    throw std::runtime_error("local sockets are not supported on this platform");
+}
+
+WeatherSocketListener::~WeatherSocketListener()
+{
+}
+
+void WeatherSocketListener::Accept()
+{
+}
+
+void WeatherSocketListener::Serve(int)
+{
+}
+
+SocketWeatherServer::SocketWeatherServer(const std::string&)
+    : m_fd(-1)
+{
+    throw std::runtime_error("local sockets are not supported on this platform");
+}
+
+SocketWeatherServer::~SocketWeatherServer()
+{
+}
+
+std::string SocketWeatherServer::GetWeather(const std::string&)
+{
+    return std::string();
+}
+#endif
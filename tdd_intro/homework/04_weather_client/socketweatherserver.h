@@ -0,0 +1,65 @@
+#pragma once
+#include "iweatherserver.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Local socket protocol: the client sends a request per line and gets a line with the response back.
+ * A line starting with '!' carries an error thrown by the served server instead.
+ * Uses unix domain sockets, on other platforms the constructors throw.
+ */
+
+// Serves another server at a socket path until destroyed, a thread per connection.
+// Requests of all connections reach the served server one at a time, it doesn't have to be thread safe.
+class WeatherSocketListener
+{
+public:
+    WeatherSocketListener(IWeatherServer& server, const std::string& path);
+    ~WeatherSocketListener();
+
+    WeatherSocketListener(const WeatherSocketListener&) = delete;
+    WeatherSocketListener& operator=(const WeatherSocketListener&) = delete;
+
+private:
+    struct Connection
+    {
+        int fd;
+        std::thread worker;
+    };
+
+    void Accept();
+    void Serve(int connection);
+
+    IWeatherServer& m_server;
+    std::string m_path;
+    int m_listenFd;
+    std::atomic<bool> m_stopping;
+    std::mutex m_serverMutex;
+    std::mutex m_mutex;
+    std::condition_variable m_connectionClosed;
+    std::vector<Connection> m_connections;
+    // Workers of closed connections, joined by the next accept
+    std::vector<std::thread> m_finished;
+    std::thread m_acceptor;
+};
+
+// Client side, throws std::runtime_error when the connection fails or the server reports an error
+class SocketWeatherServer : public IWeatherServer
+{
+public:
+    explicit SocketWeatherServer(const std::string& path);
+    ~SocketWeatherServer();
+
+    SocketWeatherServer(const SocketWeatherServer&) = delete;
+    SocketWeatherServer& operator=(const SocketWeatherServer&) = delete;
+
+    std::string GetWeather(const std::string& request) override;
+
+private:
+    int m_fd;
+    // Received bytes after the last returned line
+    std::string m_received;
+};
@@ -0,0 +1,369 @@
+#include "statskernels.h"
+#include "weather.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WEATHER_HAS_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(WEATHER_HAS_SSE2) && defined(__GNUC__)
+#define WEATHER_HAS_AVX2
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    // Independent accumulators of ComputeStats, enough to hide the latency of vector adds
+    const size_t s_lanes = 8;
+
+    const double s_degreesInQuadrant = 90;
+    const double s_radiansInDegree = 3.14159265358979323846 / 180;
+
+    // Taylor coefficients of sin and cos, enough terms for |x| <= pi/4
+    const double s_sin3 = -1.0 / 6;
+    const double s_sin5 = 1.0 / 120;
+    const double s_sin7 = -1.0 / 5040;
+    const double s_sin9 = 1.0 / 362880;
+    const double s_sin11 = -1.0 / 39916800;
+    const double s_cos2 = -1.0 / 2;
+    const double s_cos4 = 1.0 / 24;
+    const double s_cos6 = -1.0 / 720;
+    const double s_cos8 = 1.0 / 40320;
+    const double s_cos10 = -1.0 / 3628800;
+    const double s_cos12 = 1.0 / 479001600;
+
+    /*
+     * Direction d is split into a quadrant q and x = d - 90q within [-45, 45] degrees.
+     * Then sin(d) and cos(d) are sin(x) and cos(x), swapped for odd q,
+     * with the sine negated for q & 2 and the cosine for (q + 1) & 2.
+     */
+    void AddDirectionPolynomial(double degrees, DirectionSums& sums)
+    {
+        const double quadrant = std::nearbyint(degrees / s_degreesInQuadrant);
+        const double x = (degrees - quadrant * s_degreesInQuadrant) * s_radiansInDegree;
+        const double x2 = x * x;
+        const double sin = x * (1 + x2 * (s_sin3 + x2 * (s_sin5 + x2 * (s_sin7 + x2 * (s_sin9 + x2 * s_sin11)))));
+        const double cos = 1 + x2 * (s_cos2 + x2 * (s_cos4 + x2 * (s_cos6 + x2 * (s_cos8 + x2 * (s_cos10 + x2 * s_cos12)))));
+
+        const long q = std::lrint(quadrant);
+        const bool swap = (q & 1) != 0;
+        sums.sin += ((q & 2) != 0 ? -1 : 1) * (swap ? cos : sin);
+        sums.cos += (((q + 1) & 2) != 0 ? -1 : 1) * (swap ? sin : cos);
+    }
+
+    SampleStats ComputeStatsScalar(const double* samples, size_t count)
+    {
+        SampleStats stats = { count, 0, 0, 0 };
+        if (count == 0)
+        {
+            return stats;
+        }
+
+        double minimums[s_lanes];
+        double maximums[s_lanes];
+        double sums[s_lanes];
+        for (size_t lane = 0; lane < s_lanes; ++lane)
+        {
+            minimums[lane] = samples[0];
+            maximums[lane] = samples[0];
+            sums[lane] = 0;
+        }
+
+        size_t index = 0;
+        for (; index + s_lanes <= count; index += s_lanes)
+        {
+            for (size_t lane = 0; lane < s_lanes; ++lane)
+            {
+                const double sample = samples[index + lane];
+                minimums[lane] = sample < minimums[lane] ? sample : minimums[lane];
+                maximums[lane] = sample > maximums[lane] ? sample : maximums[lane];
+                sums[lane] += sample;
+            }
+        }
+        for (; index < count; ++index)
+        {
+            minimums[0] = std::min(minimums[0], samples[index]);
+            maximums[0] = std::max(maximums[0], samples[index]);
+            sums[0] += samples[index];
+        }
+
+        stats.minimum = *std::min_element(minimums, minimums + s_lanes);
+        stats.maximum = *std::max_element(maximums, maximums + s_lanes);
+        for (size_t lane = 0; lane < s_lanes; ++lane)
+        {
+            stats.sum += sums[lane];
+        }
+        return stats;
+    }
+
+#ifdef WEATHER_HAS_SSE2
+    SampleStats ComputeStatsSse2(const double* samples, size_t count)
+    {
+        if (count < s_lanes)
+        {
+            return ComputeStatsScalar(samples, count);
+        }
+
+        // Four registers of two lanes each, so adds of consecutive iterations don't wait for each other
+        __m128d minimum0 = _mm_set1_pd(samples[0]);
+        __m128d minimum1 = minimum0;
+        __m128d maximum0 = minimum0;
+        __m128d maximum1 = minimum0;
+        __m128d sum0 = _mm_setzero_pd();
+        __m128d sum1 = sum0;
+        __m128d sum2 = sum0;
+        __m128d sum3 = sum0;
+
+        size_t index = 0;
+        for (; index + s_lanes <= count; index += s_lanes)
+        {
+            const __m128d a = _mm_loadu_pd(samples + index);
+            const __m128d b = _mm_loadu_pd(samples + index + 2);
+            const __m128d c = _mm_loadu_pd(samples + index + 4);
+            const __m128d d = _mm_loadu_pd(samples + index + 6);
+            minimum0 = _mm_min_pd(minimum0, _mm_min_pd(a, b));
+            minimum1 = _mm_min_pd(minimum1, _mm_min_pd(c, d));
+            maximum0 = _mm_max_pd(maximum0, _mm_max_pd(a, b));
+            maximum1 = _mm_max_pd(maximum1, _mm_max_pd(c, d));
+            sum0 = _mm_add_pd(sum0, a);
+            sum1 = _mm_add_pd(sum1, b);
+            sum2 = _mm_add_pd(sum2, c);
+            sum3 = _mm_add_pd(sum3, d);
+        }
+
+        double minimums[2];
+        double maximums[2];
+        double sums[2];
+        _mm_storeu_pd(minimums, _mm_min_pd(minimum0, minimum1));
+        _mm_storeu_pd(maximums, _mm_max_pd(maximum0, maximum1));
+        _mm_storeu_pd(sums, _mm_add_pd(_mm_add_pd(sum0, sum1), _mm_add_pd(sum2, sum3)));
+        SampleStats stats = { count, std::min(minimums[0], minimums[1]), std::max(maximums[0], maximums[1]), sums[0] + sums[1] };
+        for (; index < count; ++index)
+        {
+            stats.minimum = std::min(stats.minimum, samples[index]);
+            stats.maximum = std::max(stats.maximum, samples[index]);
+            stats.sum += samples[index];
+        }
+        return stats;
+    }
+#endif
+
+    DirectionSums SumDirectionsScalar(const double* degrees, size_t count)
+    {
+        DirectionSums sums = { 0, 0 };
+        for (size_t index = 0; index < count; ++index)
+        {
+            const double radians = weather::ToRadians(degrees[index]);
+            sums.sin += std::sin(radians);
+            sums.cos += std::cos(radians);
+        }
+        return sums;
+    }
+
+#ifdef WEATHER_HAS_SSE2
+    DirectionSums SumDirectionsSse2(const double* degrees, size_t count)
+    {
+        const __m128d quadrantsInDegree = _mm_set1_pd(1 / s_degreesInQuadrant);
+        const __m128d degreesInQuadrant = _mm_set1_pd(s_degreesInQuadrant);
+        const __m128d radiansInDegree = _mm_set1_pd(s_radiansInDegree);
+        const __m128d signBit = _mm_set1_pd(-0.0);
+        const __m128d one = _mm_set1_pd(1);
+        const __m128i oneBit = _mm_set1_epi32(1);
+        const __m128i twoBit = _mm_set1_epi32(2);
+
+        __m128d sinSum = _mm_setzero_pd();
+        __m128d cosSum = _mm_setzero_pd();
+        size_t index = 0;
+        for (; index + 2 <= count; index += 2)
+        {
+            const __m128d direction = _mm_loadu_pd(degrees + index);
+            // Rounds to nearest, as std::nearbyint does
+            const __m128i quadrants = _mm_cvtpd_epi32(_mm_mul_pd(direction, quadrantsInDegree));
+            const __m128d x = _mm_mul_pd(_mm_sub_pd(direction, _mm_mul_pd(_mm_cvtepi32_pd(quadrants), degreesInQuadrant)),
+                                         radiansInDegree);
+            const __m128d x2 = _mm_mul_pd(x, x);
+
+            __m128d sin = _mm_set1_pd(s_sin11);
+            sin = _mm_add_pd(_mm_mul_pd(sin, x2), _mm_set1_pd(s_sin9));
+            sin = _mm_add_pd(_mm_mul_pd(sin, x2), _mm_set1_pd(s_sin7));
+            sin = _mm_add_pd(_mm_mul_pd(sin, x2), _mm_set1_pd(s_sin5));
+            sin = _mm_add_pd(_mm_mul_pd(sin, x2), _mm_set1_pd(s_sin3));
+            sin = _mm_mul_pd(_mm_add_pd(_mm_mul_pd(sin, x2), one), x);
+            __m128d cos = _mm_set1_pd(s_cos12);
+            cos = _mm_add_pd(_mm_mul_pd(cos, x2), _mm_set1_pd(s_cos10));
+            cos = _mm_add_pd(_mm_mul_pd(cos, x2), _mm_set1_pd(s_cos8));
+            cos = _mm_add_pd(_mm_mul_pd(cos, x2), _mm_set1_pd(s_cos6));
+            cos = _mm_add_pd(_mm_mul_pd(cos, x2), _mm_set1_pd(s_cos4));
+            cos = _mm_add_pd(_mm_mul_pd(cos, x2), _mm_set1_pd(s_cos2));
+            cos = _mm_add_pd(_mm_mul_pd(cos, x2), one);
+
+            // Each 32-bit quadrant into both halves of its 64-bit lane, so comparisons give masks of doubles
+            const __m128i lanes = _mm_shuffle_epi32(quadrants, _MM_SHUFFLE(1, 1, 0, 0));
+            const __m128d swap = _mm_castsi128_pd(_mm_cmpeq_epi32(_mm_and_si128(lanes, oneBit), oneBit));
+            const __m128d negateSin = _mm_castsi128_pd(_mm_cmpeq_epi32(_mm_and_si128(lanes, twoBit), twoBit));
+            const __m128d negateCos = _mm_castsi128_pd(_mm_cmpeq_epi32(_mm_and_si128(_mm_add_epi32(lanes, oneBit), twoBit), twoBit));
+
+            const __m128d swappedSin = _mm_or_pd(_mm_and_pd(swap, cos), _mm_andnot_pd(swap, sin));
+            const __m128d swappedCos = _mm_or_pd(_mm_and_pd(swap, sin), _mm_andnot_pd(swap, cos));
+            sinSum = _mm_add_pd(sinSum, _mm_xor_pd(swappedSin, _mm_and_pd(negateSin, signBit)));
+            cosSum = _mm_add_pd(cosSum, _mm_xor_pd(swappedCos, _mm_and_pd(negateCos, signBit)));
+        }
+
+        double sins[2];
+        double coss[2];
+        _mm_storeu_pd(sins, sinSum);
+        _mm_storeu_pd(coss, cosSum);
+        DirectionSums sums = { sins[0] + sins[1], coss[0] + coss[1] };
+        for (; index < count; ++index)
+        {
+            AddDirectionPolynomial(degrees[index], sums);
+        }
+        return sums;
+    }
+#endif
+
+#ifdef WEATHER_HAS_AVX2
+    __attribute__((target("avx2")))
+    DirectionSums SumDirectionsAvx2(const double* degrees, size_t count)
+    {
+        const __m256d quadrantsInDegree = _mm256_set1_pd(1 / s_degreesInQuadrant);
+        const __m256d degreesInQuadrant = _mm256_set1_pd(s_degreesInQuadrant);
+        const __m256d radiansInDegree = _mm256_set1_pd(s_radiansInDegree);
+        const __m256d signBit = _mm256_set1_pd(-0.0);
+        const __m256d one = _mm256_set1_pd(1);
+        const __m256i oneBit = _mm256_set1_epi64x(1);
+        const __m256i twoBit = _mm256_set1_epi64x(2);
+
+        __m256d sinSum = _mm256_setzero_pd();
+        __m256d cosSum = _mm256_setzero_pd();
+        size_t index = 0;
+        for (; index + 4 <= count; index += 4)
+        {
+            const __m256d direction = _mm256_loadu_pd(degrees + index);
+            const __m128i quadrants = _mm256_cvtpd_epi32(_mm256_mul_pd(direction, quadrantsInDegree));
+            const __m256d x = _mm256_mul_pd(_mm256_sub_pd(direction, _mm256_mul_pd(_mm256_cvtepi32_pd(quadrants), degreesInQuadrant)),
+                                            radiansInDegree);
+            const __m256d x2 = _mm256_mul_pd(x, x);
+
+            __m256d sin = _mm256_set1_pd(s_sin11);
+            sin = _mm256_add_pd(_mm256_mul_pd(sin, x2), _mm256_set1_pd(s_sin9));
+            sin = _mm256_add_pd(_mm256_mul_pd(sin, x2), _mm256_set1_pd(s_sin7));
+            sin = _mm256_add_pd(_mm256_mul_pd(sin, x2), _mm256_set1_pd(s_sin5));
+            sin = _mm256_add_pd(_mm256_mul_pd(sin, x2), _mm256_set1_pd(s_sin3));
+            sin = _mm256_mul_pd(_mm256_add_pd(_mm256_mul_pd(sin, x2), one), x);
+            __m256d cos = _mm256_set1_pd(s_cos12);
+            cos = _mm256_add_pd(_mm256_mul_pd(cos, x2), _mm256_set1_pd(s_cos10));
+            cos = _mm256_add_pd(_mm256_mul_pd(cos, x2), _mm256_set1_pd(s_cos8));
+            cos = _mm256_add_pd(_mm256_mul_pd(cos, x2), _mm256_set1_pd(s_cos6));
+            cos = _mm256_add_pd(_mm256_mul_pd(cos, x2), _mm256_set1_pd(s_cos4));
+            cos = _mm256_add_pd(_mm256_mul_pd(cos, x2), _mm256_set1_pd(s_cos2));
+            cos = _mm256_add_pd(_mm256_mul_pd(cos, x2), one);
+
+            const __m256i lanes = _mm256_cvtepi32_epi64(quadrants);
+            const __m256d swap = _mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(lanes, oneBit), oneBit));
+            const __m256d negateSin = _mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(lanes, twoBit), twoBit));
+            const __m256d negateCos = _mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(_mm256_add_epi64(lanes, oneBit), twoBit), twoBit));
+
+            const __m256d swappedSin = _mm256_blendv_pd(sin, cos, swap);
+            const __m256d swappedCos = _mm256_blendv_pd(cos, sin, swap);
+            sinSum = _mm256_add_pd(sinSum, _mm256_xor_pd(swappedSin, _mm256_and_pd(negateSin, signBit)));
+            cosSum = _mm256_add_pd(cosSum, _mm256_xor_pd(swappedCos, _mm256_and_pd(negateCos, signBit)));
+        }
+
+        double sins[4];
+        double coss[4];
+        _mm256_storeu_pd(sins, sinSum);
+        _mm256_storeu_pd(coss, cosSum);
+        DirectionSums sums = { sins[0] + sins[1] + sins[2] + sins[3], coss[0] + coss[1] + coss[2] + coss[3] };
+        for (; index < count; ++index)
+        {
+            AddDirectionPolynomial(degrees[index], sums);
+        }
+        return sums;
+    }
+#endif
+}
+
+bool weather::IsStatsKernelSupported(StatsKernel kernel)
+{
+    switch (kernel)
+    {
+    case StatsKernel::Scalar:
+        return true;
+#ifdef WEATHER_HAS_SSE2
+    case StatsKernel::Sse2:
+        return true;
+#endif
+#ifdef WEATHER_HAS_AVX2
+    case StatsKernel::Avx2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+weather::StatsKernel weather::GetBestStatsKernel()
+{
+    static const StatsKernel s_best = IsStatsKernelSupported(StatsKernel::Avx2) ? StatsKernel::Avx2 :
+                                      IsStatsKernelSupported(StatsKernel::Sse2) ? StatsKernel::Sse2 :
+                                                                                  StatsKernel::Scalar;
+    return s_best;
+}
+
+SampleStats weather::ComputeStats(StatsKernel kernel, const double* samples, size_t count)
+{
+    switch (kernel)
+    {
+#ifdef WEATHER_HAS_SSE2
+    // No separate AVX2 statistics kernel, the SSE2 one runs there as well
+    case StatsKernel::Avx2:
+    case StatsKernel::Sse2:
+        return ComputeStatsSse2(samples, count);
+#endif
+    default:
+        return ComputeStatsScalar(samples, count);
+    }
+}
+
+SampleStats weather::ComputeStats(const double* samples, size_t count)
+{
+    return ComputeStats(GetBestStatsKernel(), samples, count);
+}
+
+void weather::MergeStats(SampleStats& stats, const SampleStats& other)
+{
+    if (other.count == 0)
+    {
+        return;
+    }
+    stats.minimum = stats.count == 0 ? other.minimum : std::min(stats.minimum, other.minimum);
+    stats.maximum = stats.count == 0 ? other.maximum : std::max(stats.maximum, other.maximum);
+    stats.sum += other.sum;
+    stats.count += other.count;
+}
+
+DirectionSums weather::SumDirections(StatsKernel kernel, const double* degrees, size_t count)
+{
+    switch (kernel)
+    {
+#ifdef WEATHER_HAS_AVX2
+    case StatsKernel::Avx2:
+        return SumDirectionsAvx2(degrees, count);
+#endif
+#ifdef WEATHER_HAS_SSE2
+    case StatsKernel::Sse2:
+        return SumDirectionsSse2(degrees, count);
+#endif
+    default:
+        return SumDirectionsScalar(degrees, count);
+    }
+}
+
+DirectionSums weather::SumDirections(const double* degrees, size_t count)
+{
+    return SumDirections(GetBestStatsKernel(), degrees, count);
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+
+// Minimum, maximum and sum of samples
+struct SampleStats
+{
+    size_t count;
+    double minimum;
+    double maximum;
+    double sum;
+
+    // Only meaningful when count is not zero
+    double Average() const { return sum / count; }
+};
+
+// Sines and cosines of directions summed up, their atan2 is the mean direction on a circle
+struct DirectionSums
+{
+    double sin;
+    double cos;
+};
+
+namespace weather
+{
+    /*
+     * Ways to go over samples:
+     *  Scalar - portable code; statistics keep independent accumulators per lane for the vectorizer,
+     *           directions are summed with std::sin and std::cos sample by sample
+     *  Sse2   - two samples per instruction, polynomials instead of library calls for directions
+     *  Avx2   - four samples per instruction for directions, statistics same as Sse2
+     * The polynomials are accurate to about 1e-11.
+     */
+    enum class StatsKernel
+    {
+        Scalar,
+        Sse2,
+        Avx2
+    };
+
+    bool IsStatsKernelSupported(StatsKernel kernel);
+    // The fastest kernel the current CPU runs, detected once
+    StatsKernel GetBestStatsKernel();
+
+    SampleStats ComputeStats(StatsKernel kernel, const double* samples, size_t count);
+    SampleStats ComputeStats(const double* samples, size_t count);
+    void MergeStats(SampleStats& stats, const SampleStats& other);
+
+    DirectionSums SumDirections(StatsKernel kernel, const double* degrees, size_t count);
+    DirectionSums SumDirections(const double* degrees, size_t count);
+}
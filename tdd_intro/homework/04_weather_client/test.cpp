@@ -46,23 +46,958 @@ IMPORTANT:
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
+#include "mocks.h"
+#include "weatherclient.h"
+#include "fakeweatherserver.h"
+#include "cachingweatherserver.h"
+#include "batchweatherserveradapter.h"
+#include "asyncweatherserver.h"
+#include "weatherseries.h"
+#include "statskernels.h"
+#include "weatherfile.h"
+#include "persistentweatherserver.h"
+#include "simulatedweatherserver.h"
+#include "socketweatherserver.h"
+#include "cityweatheraggregator.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <atomic>
+#include <numeric>
+#include <map>
+#include <mutex>
 
-class IWeatherServer
-{
-public:
-    virtual ~IWeatherServer() { }
-    // Returns raw response with weather for the given day and time in request
-    virtual std::string GetWeather(const std::string& request) = 0;
-};
-
-// Implement this interface
-class IWeatherClient
-{
-public:
-    virtual ~IWeatherClient() { }
-    virtual double GetAverageTemperature(IWeatherServer& server, const std::string& date) = 0;
-    virtual double GetMinimumTemperature(IWeatherServer& server, const std::string& date) = 0;
-    virtual double GetMaximumTemperature(IWeatherServer& server, const std::string& date) = 0;
-    virtual double GetAverageWindDirection(IWeatherServer& server, const std::string& date) = 0;
-    virtual double GetMaximumWindSpeed(IWeatherServer& server, const std::string& date) = 0;
-};
+using namespace ::testing;
+
+TEST(WeatherClient, FakeServerAnswersRecordedRequests)
+{
+    FakeWeatherServer server;
+    EXPECT_EQ("20;181;5.1", server.GetWeather("31.08.2018;03:00"));
+    EXPECT_EQ("27;299;4.0", server.GetWeather("02.09.2018;21:00"));
+}
+
+TEST(WeatherClient, FakeServerAnswersEmptyOnInvalidRequest)
+{
+    FakeWeatherServer server;
+    EXPECT_EQ("", server.GetWeather("31.08.2018;04:00"));
+}
+
+TEST(WeatherClient, ParseResponse)
+{
+    const Weather weather = weather::ParseResponse("20;181;5.1");
+    EXPECT_DOUBLE_EQ(20, weather.temperature);
+    EXPECT_DOUBLE_EQ(181, weather.windDirection);
+    EXPECT_DOUBLE_EQ(5.1, weather.windSpeed);
+}
+
+TEST(WeatherClient, ParseNegativeTemperature)
+{
+    EXPECT_DOUBLE_EQ(-5, weather::ParseResponse("-5;0;1").temperature);
+}
+
+TEST(WeatherClient, DecodeResponse)
+{
+    Weather weather = {};
+    EXPECT_EQ(weather::ResponseStatus::Ok, weather::DecodeResponse("27;299:4.0", weather));
+    EXPECT_DOUBLE_EQ(27, weather.temperature);
+    EXPECT_DOUBLE_EQ(299, weather.windDirection);
+    EXPECT_DOUBLE_EQ(4.0, weather.windSpeed);
+}
+
+TEST(WeatherClient, DecodeEmptyResponseAsInvalidRequest)
+{
+    Weather weather = {};
+    EXPECT_EQ(weather::ResponseStatus::InvalidRequest, weather::DecodeResponse("", weather));
+}
+
+TEST(WeatherClient, DecodeMalformedResponse)
+{
+    Weather weather = {};
+    EXPECT_EQ(weather::ResponseStatus::Malformed, weather::DecodeResponse("20;181", weather));
+    EXPECT_EQ(weather::ResponseStatus::Malformed, weather::DecodeResponse("20:181;5.1", weather));
+    EXPECT_EQ(weather::ResponseStatus::Malformed, weather::DecodeResponse("20;181;5.1;", weather));
+    EXPECT_EQ(weather::ResponseStatus::Malformed, weather::DecodeResponse("20;;5.1", weather));
+    EXPECT_EQ(weather::ResponseStatus::Malformed, weather::DecodeResponse(" 20;181;5.1", weather));
+    EXPECT_EQ(weather::ResponseStatus::Malformed, weather::DecodeResponse("20;181;5,1", weather));
+    EXPECT_EQ(weather::ResponseStatus::Malformed, weather::DecodeResponse("nan;90;5", weather));
+    EXPECT_EQ(weather::ResponseStatus::Malformed, weather::DecodeResponse("-nan;90;5", weather));
+    EXPECT_EQ(weather::ResponseStatus::Malformed, weather::DecodeResponse("inf;90;5", weather));
+    EXPECT_EQ(weather::ResponseStatus::Malformed, weather::DecodeResponse("-inf;90;5", weather));
+    EXPECT_EQ(weather::ResponseStatus::Malformed, weather::DecodeResponse("20;nan;5", weather));
+    EXPECT_EQ(weather::ResponseStatus::Malformed, weather::DecodeResponse("20;90;inf", weather));
+    EXPECT_EQ(weather::ResponseStatus::Malformed, weather::DecodeResponse("20;90;infinity", weather));
+}
+
+TEST(WeatherClient, DecodeOutOfRangeResponse)
+{
+    Weather weather = { 1, 2, 3 };
+    EXPECT_EQ(weather::ResponseStatus::OutOfRange, weather::DecodeResponse("20;360;5.1", weather));
+    EXPECT_EQ(weather::ResponseStatus::OutOfRange, weather::DecodeResponse("20;-1;5.1", weather));
+    EXPECT_EQ(weather::ResponseStatus::OutOfRange, weather::DecodeResponse("20;181;-5.1", weather));
+    EXPECT_DOUBLE_EQ(1, weather.temperature);
+}
+
+TEST(WeatherClient, ParseInvalidResponse)
+{
+    EXPECT_THROW(weather::ParseResponse(""), std::runtime_error);
+    EXPECT_THROW(weather::ParseResponse("20,181,5.1"), std::runtime_error);
+    EXPECT_THROW(weather::ParseResponse("20;400;5.1"), std::runtime_error);
+}
+
+TEST(WeatherClient, Temperatures)
+{
+    FakeWeatherServer server;
+    WeatherClient client;
+    EXPECT_DOUBLE_EQ(25.5, client.GetAverageTemperature(server, "31.08.2018"));
+    EXPECT_DOUBLE_EQ(19, client.GetMinimumTemperature(server, "01.09.2018"));
+    EXPECT_DOUBLE_EQ(34, client.GetMaximumTemperature(server, "02.09.2018"));
+}
+
+TEST(WeatherClient, MaximumWindSpeed)
+{
+    FakeWeatherServer server;
+    WeatherClient client;
+    EXPECT_DOUBLE_EQ(5.1, client.GetMaximumWindSpeed(server, "31.08.2018"));
+}
+
+TEST(WeatherClient, AverageWindDirection)
+{
+    FakeWeatherServer server;
+    WeatherClient client;
+    EXPECT_NEAR(189.2, client.GetAverageWindDirection(server, "31.08.2018"), 0.1);
+}
+
+TEST(WeatherClient, AverageWindDirectionWrapsAround)
+{
+    WeatherServerMock server;
+    EXPECT_CALL(server, GetWeather(_)).WillOnce(Return("0;350;1")).WillOnce(Return("0;10;1"))
+            .WillOnce(Return("0;340;1")).WillOnce(Return("0;20;1"));
+    WeatherClient client;
+    const double direction = client.GetAverageWindDirection(server, "01.01.2019");
+    EXPECT_NEAR(0, std::min(direction, 360 - direction), 1e-9);
+}
+
+TEST(WeatherClient, InvalidDateThrows)
+{
+    FakeWeatherServer server;
+    WeatherClient client;
+    EXPECT_THROW(client.GetAverageTemperature(server, "32.08.2018"), std::runtime_error);
+}
+
+TEST(WeatherClient, CacheServesRepeatedRequests)
+{
+    StrictMock<WeatherServerMock> upstream;
+    NiceMock<ClockMock> clock;
+    ON_CALL(clock, Now()).WillByDefault(Return(std::chrono::steady_clock::time_point()));
+    EXPECT_CALL(upstream, GetWeather("31.08.2018;03:00")).WillOnce(Return("20;181;5.1"));
+
+    CachingWeatherServer cache(upstream, clock, std::chrono::hours(1), 1024 * 1024);
+    EXPECT_EQ("20;181;5.1", cache.GetWeather("31.08.2018;03:00"));
+    EXPECT_EQ("20;181;5.1", cache.GetWeather("31.08.2018;03:00"));
+    EXPECT_EQ(1u, cache.GetHits());
+    EXPECT_EQ(1u, cache.GetMisses());
+}
+
+TEST(WeatherClient, CachedStatisticsFetchEachSlotOnce)
+{
+    FakeWeatherServer fake;
+    StrictMock<WeatherServerMock> upstream;
+    EXPECT_CALL(upstream, GetWeather(_)).Times(4).WillRepeatedly(Invoke(&fake, &FakeWeatherServer::GetWeather));
+    SteadyClock clock;
+    CachingWeatherServer cache(upstream, clock, std::chrono::hours(1), 1024 * 1024);
+
+    WeatherClient client;
+    client.GetAverageTemperature(cache, "31.08.2018");
+    client.GetMinimumTemperature(cache, "31.08.2018");
+    client.GetMaximumTemperature(cache, "31.08.2018");
+    client.GetAverageWindDirection(cache, "31.08.2018");
+    client.GetMaximumWindSpeed(cache, "31.08.2018");
+    EXPECT_EQ(16u, cache.GetHits());
+}
+
+TEST(WeatherClient, CacheEntryExpires)
+{
+    StrictMock<WeatherServerMock> upstream;
+    NiceMock<ClockMock> clock;
+    std::chrono::steady_clock::time_point now;
+    ON_CALL(clock, Now()).WillByDefault(ReturnPointee(&now));
+    EXPECT_CALL(upstream, GetWeather("31.08.2018;03:00")).Times(2).WillRepeatedly(Return("20;181;5.1"));
+
+    CachingWeatherServer cache(upstream, clock, std::chrono::minutes(10), 1024 * 1024);
+    cache.GetWeather("31.08.2018;03:00");
+    now += std::chrono::minutes(9);
+    cache.GetWeather("31.08.2018;03:00");
+    now += std::chrono::minutes(10);
+    cache.GetWeather("31.08.2018;03:00");
+    EXPECT_EQ(1u, cache.GetHits());
+    EXPECT_EQ(2u, cache.GetMisses());
+}
+
+TEST(WeatherClient, CacheDoesNotStoreInvalidResponses)
+{
+    StrictMock<WeatherServerMock> upstream;
+    SteadyClock clock;
+    EXPECT_CALL(upstream, GetWeather("bad")).Times(2).WillRepeatedly(Return(""));
+
+    CachingWeatherServer cache(upstream, clock, std::chrono::hours(1), 1024 * 1024);
+    EXPECT_EQ("", cache.GetWeather("bad"));
+    EXPECT_EQ("", cache.GetWeather("bad"));
+    EXPECT_EQ(0u, cache.GetSize());
+}
+
+TEST(WeatherClient, CacheEvictsLeastRecentlyUsed)
+{
+    FakeWeatherServer upstream;
+    SteadyClock clock;
+    CachingWeatherServer probe(upstream, clock, std::chrono::hours(1), 1024 * 1024);
+    probe.GetWeather("31.08.2018;03:00");
+
+    // Room for two entries only
+    CachingWeatherServer cache(upstream, clock, std::chrono::hours(1), probe.GetMemoryUsage() * 2);
+    cache.GetWeather("31.08.2018;03:00");
+    cache.GetWeather("31.08.2018;09:00");
+    cache.GetWeather("31.08.2018;03:00");
+    cache.GetWeather("31.08.2018;15:00");
+    EXPECT_EQ(2u, cache.GetSize());
+    EXPECT_LE(cache.GetMemoryUsage(), probe.GetMemoryUsage() * 2);
+
+    cache.GetWeather("31.08.2018;03:00");
+    EXPECT_EQ(2u, cache.GetHits());
+    cache.GetWeather("31.08.2018;09:00");
+    EXPECT_EQ(4u, cache.GetMisses());
+}
+
+TEST(WeatherClient, AdapterSendsBatchAsSingleRequests)
+{
+    StrictMock<WeatherServerMock> server;
+    EXPECT_CALL(server, GetWeather("31.08.2018;03:00")).WillOnce(Return("20;181;5.1"));
+    EXPECT_CALL(server, GetWeather("31.08.2018;09:00")).WillOnce(Return("23;204;4.9"));
+
+    BatchWeatherServerAdapter adapter(server);
+    const std::vector<std::string> responses = adapter.GetWeatherBatch({ "31.08.2018;03:00", "31.08.2018;09:00" });
+    EXPECT_EQ(std::vector<std::string>({ "20;181;5.1", "23;204;4.9" }), responses);
+}
+
+TEST(WeatherClient, BatchWithMissingResponsesIsRejected)
+{
+    StrictMock<BatchWeatherServerMock> upstream;
+    EXPECT_CALL(upstream, GetWeatherBatch(_)).WillOnce(Return(std::vector<std::string>({ "20;181;5.1" })));
+    NiceMock<ClockMock> clock;
+    ON_CALL(clock, Now()).WillByDefault(Return(std::chrono::steady_clock::time_point()));
+
+    CachingWeatherServer cache(upstream, clock, std::chrono::hours(1), 1024 * 1024);
+    EXPECT_THROW(cache.GetWeatherBatch({ "31.08.2018;03:00", "31.08.2018;09:00" }), std::runtime_error);
+}
+
+TEST(WeatherClient, DayWeatherTakesOneBatch)
+{
+    StrictMock<BatchWeatherServerMock> server;
+    EXPECT_CALL(server, GetWeatherBatch(ElementsAre("31.08.2018;03:00", "31.08.2018;09:00",
+                                                    "31.08.2018;15:00", "31.08.2018;21:00")))
+            .WillOnce(Return(std::vector<std::string>({ "20;181;5.1", "23;204;4.9", "33;193;4.3", "26;179;4.5" })));
+
+    WeatherClient client;
+    EXPECT_DOUBLE_EQ(33, client.GetMaximumTemperature(server, "31.08.2018"));
+}
+
+TEST(WeatherClient, DaysWeatherTakesOneRoundTrip)
+{
+    FakeWeatherServer server;
+    const std::vector<Weather> weather = weather::GetDaysWeather(server, { "31.08.2018", "01.09.2018", "02.09.2018" });
+    ASSERT_EQ(3u * g_slotsPerDay, weather.size());
+    EXPECT_DOUBLE_EQ(20, weather[0].temperature);
+    EXPECT_DOUBLE_EQ(4.0, weather.back().windSpeed);
+    EXPECT_EQ(1u, server.GetRoundTrips());
+}
+
+TEST(WeatherClient, DaysWeatherWithInvalidDateThrows)
+{
+    FakeWeatherServer server;
+    EXPECT_THROW(weather::GetDaysWeather(server, { "31.08.2018", "32.08.2018" }), std::runtime_error);
+}
+
+TEST(WeatherClient, CacheFetchesMissesInOneBatch)
+{
+    SteadyClock clock;
+    StrictMock<BatchWeatherServerMock> batchUpstream;
+    EXPECT_CALL(batchUpstream, GetWeatherBatch(ElementsAre("31.08.2018;03:00", "31.08.2018;15:00")))
+            .WillOnce(Return(std::vector<std::string>({ "20;181;5.1", "33;193;4.3" })));
+    CachingWeatherServer batchCache(batchUpstream, clock, std::chrono::hours(1), 1024 * 1024);
+    EXPECT_CALL(batchUpstream, GetWeather("31.08.2018;09:00")).WillOnce(Return("23;204;4.9"));
+    batchCache.GetWeather("31.08.2018;09:00");
+
+    const std::vector<std::string> responses = batchCache.GetWeatherBatch({ "31.08.2018;03:00", "31.08.2018;09:00", "31.08.2018;15:00" });
+    EXPECT_EQ(std::vector<std::string>({ "20;181;5.1", "23;204;4.9", "33;193;4.3" }), responses);
+    EXPECT_EQ(1u, batchCache.GetHits());
+    EXPECT_EQ(3u, batchCache.GetSize());
+}
+
+TEST(WeatherClient, AsyncServerAnswersRequests)
+{
+    FakeWeatherServer upstream;
+    AsyncWeatherServer server(upstream, 2);
+    std::shared_future<std::string> first = server.GetWeatherAsync("31.08.2018;03:00");
+    std::shared_future<std::string> second = server.GetWeatherAsync("02.09.2018;21:00");
+    EXPECT_EQ("20;181;5.1", first.get());
+    EXPECT_EQ("27;299;4.0", second.get());
+}
+
+TEST(WeatherClient, AsyncServerCoalescesRequestsInFlight)
+{
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    StrictMock<WeatherServerMock> upstream;
+    EXPECT_CALL(upstream, GetWeather("31.08.2018;03:00")).WillOnce(Invoke([released](const std::string&)
+    {
+        released.wait();
+        return std::string("20;181;5.1");
+    }));
+
+    AsyncWeatherServer server(upstream, 4);
+    std::shared_future<std::string> first = server.GetWeatherAsync("31.08.2018;03:00");
+    std::shared_future<std::string> second = server.GetWeatherAsync("31.08.2018;03:00");
+    release.set_value();
+    EXPECT_EQ("20;181;5.1", first.get());
+    EXPECT_EQ("20;181;5.1", second.get());
+    EXPECT_EQ(1u, server.GetUpstreamCalls());
+}
+
+TEST(WeatherClient, AsyncServerKeepsConcurrencyLimit)
+{
+    std::atomic<unsigned> running(0);
+    std::atomic<unsigned> maxRunning(0);
+    NiceMock<WeatherServerMock> upstream;
+    ON_CALL(upstream, GetWeather(_)).WillByDefault(Invoke([&](const std::string&)
+    {
+        const unsigned now = ++running;
+        unsigned seen = maxRunning;
+        while (now > seen && !maxRunning.compare_exchange_weak(seen, now))
+        {
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        --running;
+        return std::string("20;181;5.1");
+    }));
+
+    AsyncWeatherServer server(upstream, 3);
+    std::vector<std::string> requests;
+    const uint32_t first = weather::ParseDate("10.08.2018");
+    for (uint32_t day = first; day < first + 10; ++day)
+    {
+        requests.push_back(weather::FormatRequest(weather::MakeTimestamp(day, 0)));
+    }
+    server.GetWeatherBatch(requests);
+    EXPECT_LE(maxRunning.load(), 3u);
+    EXPECT_EQ(10u, server.GetUpstreamCalls());
+}
+
+TEST(WeatherClient, AsyncServerPassesUpstreamErrors)
+{
+    StrictMock<WeatherServerMock> upstream;
+    EXPECT_CALL(upstream, GetWeather(_)).WillOnce(Throw(std::runtime_error("connection lost")));
+    AsyncWeatherServer server(upstream, 1);
+    EXPECT_THROW(server.GetWeather("31.08.2018;03:00"), std::runtime_error);
+}
+
+TEST(WeatherClient, StatisticsThroughAsyncServer)
+{
+    FakeWeatherServer upstream;
+    AsyncWeatherServer server(upstream, 4);
+    WeatherClient client;
+    EXPECT_DOUBLE_EQ(25.5, client.GetAverageTemperature(server, "31.08.2018"));
+    EXPECT_EQ(g_slotsPerDay, upstream.GetRoundTrips());
+}
+
+TEST(WeatherClient, ParseDate)
+{
+    EXPECT_EQ(0u, weather::ParseDate("01.01.1970"));
+    EXPECT_EQ(17774u, weather::ParseDate("31.08.2018"));
+    EXPECT_EQ(11016u, weather::ParseDate("29.02.2000"));
+    EXPECT_EQ(weather::ParseDate("31.08.2018") + 1, weather::ParseDate("01.09.2018"));
+}
+
+TEST(WeatherClient, ParseInvalidDate)
+{
+    EXPECT_THROW(weather::ParseDate("1.9.2018"), std::runtime_error);
+    EXPECT_THROW(weather::ParseDate("01-09-2018"), std::runtime_error);
+    EXPECT_THROW(weather::ParseDate("29.02.2018"), std::runtime_error);
+    EXPECT_THROW(weather::ParseDate("31.09.2018"), std::runtime_error);
+    EXPECT_THROW(weather::ParseDate("01.13.2018"), std::runtime_error);
+}
+
+TEST(WeatherClient, SeriesOfRecordedDates)
+{
+    FakeWeatherServer server;
+    WeatherSeries series;
+    weather::LoadSeries(server, { "31.08.2018", "01.09.2018", "02.09.2018" }, series);
+    ASSERT_EQ(3u * g_slotsPerDay, series.GetSize());
+
+    const Timestamp from = weather::MakeTimestamp(weather::ParseDate("31.08.2018"), 0);
+    const Timestamp to = weather::MakeTimestamp(weather::ParseDate("03.09.2018"), 0);
+    const WeatherSeries::Aggregate temperature = series.GetTemperature(from, to);
+    EXPECT_DOUBLE_EQ(19, temperature.minimum);
+    EXPECT_DOUBLE_EQ(34, temperature.maximum);
+    EXPECT_DOUBLE_EQ((25.5 + 24 + 26.75) / 3, temperature.Average());
+    EXPECT_DOUBLE_EQ(5.1, series.GetWindSpeed(from, to).maximum);
+}
+
+TEST(WeatherClient, SeriesAgreesWithClientForDate)
+{
+    FakeWeatherServer server;
+    WeatherSeries series;
+    weather::LoadSeries(server, { "31.08.2018", "01.09.2018", "02.09.2018" }, series);
+
+    const uint32_t day = weather::ParseDate("01.09.2018");
+    const Timestamp from = weather::MakeTimestamp(day, 0);
+    const Timestamp to = weather::MakeTimestamp(day + 1, 0);
+    WeatherClient client;
+    EXPECT_DOUBLE_EQ(client.GetAverageTemperature(server, "01.09.2018"), series.GetTemperature(from, to).Average());
+    EXPECT_DOUBLE_EQ(client.GetMinimumTemperature(server, "01.09.2018"), series.GetTemperature(from, to).minimum);
+    EXPECT_DOUBLE_EQ(client.GetMaximumWindSpeed(server, "01.09.2018"), series.GetWindSpeed(from, to).maximum);
+    EXPECT_NEAR(client.GetAverageWindDirection(server, "01.09.2018"), series.GetAverageWindDirection(from, to), 1e-9);
+}
+
+TEST(WeatherClient, SeriesRangesAcrossBlocks)
+{
+    WeatherSeries series;
+    std::vector<double> temperatures;
+    std::vector<double> directions;
+    // Directions within a quadrant, so every range has a mean one
+    for (Timestamp timestamp = 0; timestamp < 3000; ++timestamp)
+    {
+        const Weather weather = { static_cast<double>(timestamp * 37 % 50) - 10, static_cast<double>(timestamp * 7 % 90), 1 };
+        series.Append(timestamp, weather);
+        temperatures.push_back(weather.temperature);
+        directions.push_back(weather.windDirection);
+    }
+
+    std::vector<std::pair<Timestamp, Timestamp>> ranges = { { 0, 3000 }, { 5, 6 }, { 255, 257 }, { 100, 1900 }, { 512, 768 }, { 2999, 5000 } };
+    // Runs of any number of whole blocks
+    for (Timestamp from = 0; from < 3000; from += 97)
+    {
+        for (Timestamp to = from + 1; to <= 3000; to += 131)
+        {
+            ranges.push_back({ from, to });
+        }
+    }
+    for (const auto& range : ranges)
+    {
+        const size_t last = std::min<size_t>(range.second, temperatures.size());
+        const WeatherSeries::Aggregate temperature = series.GetTemperature(range.first, range.second);
+        ASSERT_EQ(last - range.first, temperature.count);
+        EXPECT_DOUBLE_EQ(*std::min_element(temperatures.begin() + range.first, temperatures.begin() + last), temperature.minimum);
+        EXPECT_DOUBLE_EQ(*std::max_element(temperatures.begin() + range.first, temperatures.begin() + last), temperature.maximum);
+        EXPECT_DOUBLE_EQ(std::accumulate(temperatures.begin() + range.first, temperatures.begin() + last, 0.0), temperature.sum);
+        const DirectionSums sums = weather::SumDirections(directions.data() + range.first, last - range.first);
+        EXPECT_NEAR(weather::MeanDirection(sums.sin, sums.cos), series.GetAverageWindDirection(range.first, range.second), 1e-6);
+    }
+    EXPECT_EQ(0u, series.GetTemperature(4000, 5000).count);
+    EXPECT_EQ(0u, series.GetTemperature(20, 10).count);
+}
+
+TEST(WeatherClient, SeriesRejectsReadingsOutOfOrder)
+{
+    WeatherSeries series;
+    series.Append(10, Weather());
+    EXPECT_THROW(series.Append(10, Weather()), std::runtime_error);
+    EXPECT_THROW(series.Append(9, Weather()), std::runtime_error);
+}
+
+TEST(WeatherClient, ComputeStats)
+{
+    const double samples[] = { 20, 23, 33, 26, 19, 22, 31 };
+    const SampleStats stats = weather::ComputeStats(samples, 7);
+    EXPECT_EQ(7u, stats.count);
+    EXPECT_DOUBLE_EQ(19, stats.minimum);
+    EXPECT_DOUBLE_EQ(33, stats.maximum);
+    EXPECT_DOUBLE_EQ(174, stats.sum);
+    EXPECT_EQ(0u, weather::ComputeStats(samples, 0).count);
+}
+
+TEST(WeatherClient, StatsKernelsAgree)
+{
+    std::vector<double> samples;
+    for (int index = 0; index < 1001; ++index)
+    {
+        samples.push_back(static_cast<double>(index * 37 % 50) - 10 + (index == 777 ? 100 : 0));
+    }
+
+    const weather::StatsKernel kernels[] = { weather::StatsKernel::Scalar, weather::StatsKernel::Sse2, weather::StatsKernel::Avx2 };
+    for (weather::StatsKernel kernel : kernels)
+    {
+        if (!weather::IsStatsKernelSupported(kernel))
+        {
+            continue;
+        }
+        for (size_t count : { size_t(1), size_t(9), samples.size() })
+        {
+            const SampleStats stats = weather::ComputeStats(kernel, samples.data(), count);
+            EXPECT_EQ(count, stats.count);
+            EXPECT_DOUBLE_EQ(*std::min_element(samples.begin(), samples.begin() + count), stats.minimum);
+            EXPECT_DOUBLE_EQ(*std::max_element(samples.begin(), samples.begin() + count), stats.maximum);
+            EXPECT_DOUBLE_EQ(std::accumulate(samples.begin(), samples.begin() + count, 0.0), stats.sum);
+        }
+    }
+}
+
+TEST(WeatherClient, DirectionKernelsAgree)
+{
+    std::vector<double> directions;
+    for (int direction = -720; direction <= 720; ++direction)
+    {
+        directions.push_back(direction + 0.25 * (direction % 4));
+    }
+
+    const weather::StatsKernel kernels[] = { weather::StatsKernel::Sse2, weather::StatsKernel::Avx2 };
+    for (size_t count : { size_t(0), size_t(1), size_t(3), size_t(5), directions.size() })
+    {
+        const DirectionSums expected = weather::SumDirections(weather::StatsKernel::Scalar, directions.data(), count);
+        for (weather::StatsKernel kernel : kernels)
+        {
+            if (!weather::IsStatsKernelSupported(kernel))
+            {
+                continue;
+            }
+            const DirectionSums sums = weather::SumDirections(kernel, directions.data(), count);
+            EXPECT_NEAR(expected.sin, sums.sin, 1e-9);
+            EXPECT_NEAR(expected.cos, sums.cos, 1e-9);
+        }
+    }
+}
+
+TEST(WeatherClient, MeanOfOppositeNorthDirections)
+{
+    const double directions[] = { 350, 10, 355, 5, 340 };
+    const DirectionSums sums = weather::SumDirections(directions, 4);
+    const double mean = weather::MeanDirection(sums.sin, sums.cos);
+    EXPECT_NEAR(0, std::min(mean, 360 - mean), 1e-9);
+}
+
+namespace
+{
+    std::string MakeWeatherFilePath(const std::string& name)
+    {
+        const std::string path = testing::TempDir() + name;
+        std::remove(path.c_str());
+        return path;
+    }
+
+    void RemoveWeatherFile(const std::string& path)
+    {
+        std::remove(path.c_str());
+        std::remove((path + ".lock").c_str());
+    }
+}
+
+TEST(WeatherClient, DecodeRequest)
+{
+    Timestamp timestamp = 0;
+    ASSERT_TRUE(weather::DecodeRequest("31.08.2018;15:00", timestamp));
+    EXPECT_EQ(weather::MakeTimestamp(weather::ParseDate("31.08.2018"), 2), timestamp);
+    EXPECT_FALSE(weather::DecodeRequest("31.08.2018;16:00", timestamp));
+    EXPECT_FALSE(weather::DecodeRequest("32.08.2018;15:00", timestamp));
+    EXPECT_FALSE(weather::DecodeRequest("31.08.2018", timestamp));
+    EXPECT_FALSE(weather::DecodeRequest("+1.08.2018;15:00", timestamp));
+    EXPECT_FALSE(weather::DecodeRequest("31.08.2018;15:00 ", timestamp));
+}
+
+TEST(WeatherClient, TimestampPacksDaysAndSlot)
+{
+    const Timestamp timestamp = weather::MakeTimestamp(weather::ParseDate("31.08.2018"), 2);
+    EXPECT_EQ(weather::ParseDate("31.08.2018"), weather::GetDays(timestamp));
+    EXPECT_EQ(2u, weather::GetSlot(timestamp));
+    EXPECT_EQ("31.08.2018;15:00", weather::FormatRequest(timestamp));
+    EXPECT_EQ("01.01.1970;03:00", weather::FormatRequest(0));
+    EXPECT_THROW(weather::FormatRequest(weather::MakeTimestamp(weather::ParseDate("31.12.9999") + 1, 0)), std::runtime_error);
+}
+
+TEST(WeatherClient, RequestsRoundTripThroughTimestamps)
+{
+    const Timestamp last = weather::MakeTimestamp(weather::ParseDate("31.12.2100"), g_slotsPerDay - 1);
+    for (Timestamp timestamp = 0; timestamp <= last; ++timestamp)
+    {
+        char request[g_requestLength];
+        ASSERT_TRUE(weather::EncodeRequest(timestamp, request));
+        Timestamp decoded = 0;
+        ASSERT_TRUE(weather::DecodeRequest(std::string_view(request, g_requestLength), decoded));
+        ASSERT_EQ(timestamp, decoded);
+    }
+}
+
+TEST(WeatherClient, FormatResponse)
+{
+    EXPECT_EQ("20;181;5.1", weather::FormatResponse(weather::ParseResponse("20;181;5.1")));
+    EXPECT_EQ("-3.5;0;14.25", weather::FormatResponse(weather::ParseResponse("-3.5;0;14.25")));
+}
+
+TEST(WeatherClient, WeatherFileKeepsReadings)
+{
+    const std::string path = MakeWeatherFilePath("weather_keeps.dat");
+    {
+        WeatherFile file(path, WeatherFile::Mode::ReadWrite);
+        EXPECT_EQ(0u, file.GetSize());
+        file.Append(100, { 20, 181, 5.1 });
+        file.Append(101, { 23, 204, 4.9 });
+        file.Append(100, { 0, 0, 0 });
+        EXPECT_EQ(2u, file.GetSize());
+    }
+
+    WeatherFile file(path, WeatherFile::Mode::ReadOnly);
+    EXPECT_EQ(2u, file.GetSize());
+    Weather weather = {};
+    ASSERT_TRUE(file.Find(100, weather));
+    EXPECT_DOUBLE_EQ(20, weather.temperature);
+    EXPECT_DOUBLE_EQ(5.1, weather.windSpeed);
+    EXPECT_FALSE(file.Find(102, weather));
+    EXPECT_THROW(file.Append(102, weather), std::runtime_error);
+    RemoveWeatherFile(path);
+}
+
+TEST(WeatherClient, WeatherFileSharedWithReader)
+{
+    const std::string path = MakeWeatherFilePath("weather_shared.dat");
+    WeatherFile writer(path, WeatherFile::Mode::ReadWrite);
+    WeatherFile reader(path, WeatherFile::Mode::ReadOnly);
+    EXPECT_THROW(WeatherFile(path, WeatherFile::Mode::ReadWrite), std::runtime_error);
+
+    Weather weather = {};
+    writer.Append(7, { 20, 181, 5.1 });
+    EXPECT_TRUE(reader.Find(7, weather));
+    EXPECT_FALSE(reader.Refresh());
+
+    // Past the initial capacity the writer switches to a grown copy of the file
+    for (Timestamp timestamp = 8; timestamp < 3000; ++timestamp)
+    {
+        writer.Append(timestamp, { static_cast<double>(timestamp), 0, 1 });
+    }
+    EXPECT_EQ(2993u, writer.GetSize());
+    EXPECT_FALSE(reader.Find(2999, weather));
+    EXPECT_TRUE(reader.Refresh());
+    ASSERT_TRUE(reader.Find(2999, weather));
+    EXPECT_DOUBLE_EQ(2999, weather.temperature);
+    EXPECT_TRUE(reader.Find(7, weather));
+    RemoveWeatherFile(path);
+}
+
+TEST(WeatherClient, WeatherFileRejectsOtherFiles)
+{
+    const std::string path = MakeWeatherFilePath("weather_other.dat");
+    EXPECT_THROW(WeatherFile(path, WeatherFile::Mode::ReadOnly), std::runtime_error);
+    std::ofstream(path) << "20;181;5.1";
+    EXPECT_THROW(WeatherFile(path, WeatherFile::Mode::ReadOnly), std::runtime_error);
+    EXPECT_THROW(WeatherFile(path, WeatherFile::Mode::ReadWrite), std::runtime_error);
+    RemoveWeatherFile(path);
+}
+
+TEST(WeatherClient, PersistentServerFetchesHistoryOnce)
+{
+    const std::string path = MakeWeatherFilePath("weather_history.dat");
+    FakeWeatherServer fake;
+    {
+        StrictMock<WeatherServerMock> upstream;
+        EXPECT_CALL(upstream, GetWeather(_)).Times(4).WillRepeatedly(Invoke(&fake, &FakeWeatherServer::GetWeather));
+        WeatherFile file(path, WeatherFile::Mode::ReadWrite);
+        PersistentWeatherServer server(upstream, file);
+        WeatherClient client;
+        EXPECT_DOUBLE_EQ(25.5, client.GetAverageTemperature(server, "31.08.2018"));
+    }
+
+    // Next run answers from the file only
+    StrictMock<WeatherServerMock> upstream;
+    WeatherFile file(path, WeatherFile::Mode::ReadOnly);
+    PersistentWeatherServer server(upstream, file);
+    WeatherClient client;
+    EXPECT_DOUBLE_EQ(25.5, client.GetAverageTemperature(server, "31.08.2018"));
+    EXPECT_DOUBLE_EQ(5.1, client.GetMaximumWindSpeed(server, "31.08.2018"));
+    RemoveWeatherFile(path);
+}
+
+TEST(WeatherClient, PersistentServerSkipsInvalidRequests)
+{
+    const std::string path = MakeWeatherFilePath("weather_invalid.dat");
+    FakeWeatherServer upstream;
+    WeatherFile file(path, WeatherFile::Mode::ReadWrite);
+    PersistentWeatherServer server(upstream, file);
+    EXPECT_EQ("", server.GetWeather("31.08.2018;04:00"));
+    EXPECT_EQ("", server.GetWeather("03.09.2018;03:00"));
+    EXPECT_EQ(0u, file.GetSize());
+    RemoveWeatherFile(path);
+}
+
+TEST(WeatherClient, SimulatorIsDeterministic)
+{
+    SteadyClock clock;
+    SimulatorSettings settings;
+    settings.seed = 42;
+    SimulatedWeatherServer first(settings, clock);
+    SimulatedWeatherServer second(settings, clock);
+    settings.seed = 43;
+    SimulatedWeatherServer other(settings, clock);
+
+    EXPECT_EQ(first.GetWeather("31.08.2018;03:00"), second.GetWeather("31.08.2018;03:00"));
+    EXPECT_EQ(first.GetWeather("01.01.2016;15:00"), second.GetWeather("01.01.2016;15:00"));
+    EXPECT_NE(first.GetWeather("31.08.2018;03:00"), other.GetWeather("31.08.2018;03:00"));
+}
+
+TEST(WeatherClient, SimulatorGivesPlausibleReadings)
+{
+    SteadyClock clock;
+    SimulatedWeatherServer server(SimulatorSettings(), clock);
+    double summer = 0;
+    double winter = 0;
+    for (uint32_t day = weather::ParseDate("01.01.2018"); day < weather::ParseDate("01.01.2019"); ++day)
+    {
+        for (unsigned short slot = 0; slot < g_slotsPerDay; ++slot)
+        {
+            const Timestamp timestamp = weather::MakeTimestamp(day, slot);
+            Weather weather = {};
+            ASSERT_EQ(weather::ResponseStatus::Ok, weather::DecodeResponse(weather::FormatResponse(server.GetReading(timestamp)), weather));
+            EXPECT_GT(45, std::abs(weather.temperature));
+            EXPECT_GT(20, weather.windSpeed);
+        }
+    }
+    for (unsigned short slot = 0; slot < g_slotsPerDay; ++slot)
+    {
+        summer += server.GetReading(weather::MakeTimestamp(weather::ParseDate("15.07.2018"), slot)).temperature;
+        winter += server.GetReading(weather::MakeTimestamp(weather::ParseDate("15.01.2018"), slot)).temperature;
+    }
+    EXPECT_GT(summer, winter);
+}
+
+TEST(WeatherClient, SimulatorAnswersEmptyOutsideOfHistory)
+{
+    SteadyClock clock;
+    SimulatedWeatherServer server(SimulatorSettings(), clock);
+    EXPECT_NE("", server.GetWeather("31.12.2019;21:00"));
+    EXPECT_EQ("", server.GetWeather("01.01.2020;03:00"));
+    EXPECT_EQ("", server.GetWeather("31.12.2014;03:00"));
+    EXPECT_EQ("", server.GetWeather("31.08.2018;04:00"));
+}
+
+TEST(WeatherClient, SimulatorInjectsFailures)
+{
+    SteadyClock clock;
+    SimulatorSettings settings;
+    settings.failureRate = 0.5;
+    SimulatedWeatherServer server(settings, clock);
+
+    const std::vector<std::string> responses = server.GetWeatherBatch(std::vector<std::string>(1000, "31.08.2018;03:00"));
+    const size_t failures = std::count(responses.begin(), responses.end(), "");
+    EXPECT_LT(400u, failures);
+    EXPECT_GT(600u, failures);
+}
+
+TEST(WeatherClient, SimulatorLimitsRate)
+{
+    NiceMock<ClockMock> clock;
+    std::chrono::steady_clock::time_point now;
+    ON_CALL(clock, Now()).WillByDefault(ReturnPointee(&now));
+    SimulatorSettings settings;
+    settings.rateLimit = 2;
+    settings.rateLimitBurst = 2;
+    SimulatedWeatherServer server(settings, clock);
+
+    server.GetWeather("31.08.2018;03:00");
+    server.GetWeatherBatch({ "31.08.2018;09:00", "31.08.2018;15:00" });
+    EXPECT_THROW(server.GetWeather("31.08.2018;21:00"), RateLimitExceeded);
+    now += std::chrono::milliseconds(500);
+    EXPECT_NE("", server.GetWeather("31.08.2018;21:00"));
+    EXPECT_THROW(server.GetWeather("31.08.2018;21:00"), RateLimitExceeded);
+}
+
+TEST(WeatherClient, SimulatorWaitsForLatency)
+{
+    SteadyClock clock;
+    SimulatorSettings settings;
+    settings.latencyDistribution = LatencyDistribution::Uniform;
+    settings.latency = std::chrono::milliseconds(10);
+    settings.latencySpread = 0.5;
+    SimulatedWeatherServer server(settings, clock);
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    server.GetWeather("31.08.2018;03:00");
+    EXPECT_LE(std::chrono::milliseconds(5), std::chrono::steady_clock::now() - start);
+}
+
+TEST(WeatherClient, ServerOverLocalSocket)
+{
+    const std::string path = MakeWeatherFilePath("weather.sock");
+    NiceMock<ClockMock> clock;
+    ON_CALL(clock, Now()).WillByDefault(Return(std::chrono::steady_clock::time_point()));
+    SimulatorSettings settings;
+    settings.rateLimit = 1;
+    settings.rateLimitBurst = 2;
+    SimulatedWeatherServer simulator(settings, clock);
+    WeatherSocketListener listener(simulator, path);
+
+    SocketWeatherServer server(path);
+    EXPECT_EQ(simulator.GetWeather("31.08.2018;03:00"), server.GetWeather("31.08.2018;03:00"));
+    EXPECT_THROW(server.GetWeather("31.08.2018;09:00"), std::runtime_error);
+
+    WeatherClient client;
+    SocketWeatherServer secondConnection(path);
+    EXPECT_THROW(client.GetAverageTemperature(secondConnection, "31.08.2018"), std::runtime_error);
+}
+
+TEST(WeatherClient, ListenerCallsServerFromOneConnectionAtATime)
+{
+    const std::string path = MakeWeatherFilePath("serial.sock");
+    std::atomic<unsigned> running(0);
+    std::atomic<unsigned> maxRunning(0);
+    NiceMock<WeatherServerMock> upstream;
+    ON_CALL(upstream, GetWeather(_)).WillByDefault(Invoke([&](const std::string&)
+    {
+        const unsigned now = ++running;
+        unsigned seen = maxRunning;
+        while (now > seen && !maxRunning.compare_exchange_weak(seen, now))
+        {
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        --running;
+        return std::string("20;181;5.1");
+    }));
+    WeatherSocketListener listener(upstream, path);
+
+    std::vector<std::thread> clients;
+    for (int client = 0; client < 4; ++client)
+    {
+        clients.emplace_back([&path]()
+        {
+            SocketWeatherServer server(path);
+            for (int request = 0; request < 5; ++request)
+            {
+                server.GetWeather("31.08.2018;03:00");
+            }
+        });
+    }
+    for (std::thread& client : clients)
+    {
+        client.join();
+    }
+    EXPECT_EQ(1u, maxRunning.load());
+}
+
+namespace
+{
+    // Open descriptors or running threads of the process, where the system tells
+    size_t CountEntries(const std::string& directory)
+    {
+        std::error_code error;
+        size_t count = 0;
+        for (std::filesystem::directory_iterator entry(directory, error), end; !error && entry != end; entry.increment(error))
+        {
+            ++count;
+        }
+        return count;
+    }
+
+    template<typename Condition>
+    bool WaitFor(Condition condition)
+    {
+        for (int attempt = 0; attempt < 500 && !condition(); ++attempt)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        return condition();
+    }
+}
+
+TEST(WeatherClient, ListenerReleasesClosedConnections)
+{
+    if (!std::filesystem::exists("/proc/self/fd"))
+    {
+        return;
+    }
+    const std::string path = MakeWeatherFilePath("closed.sock");
+    FakeWeatherServer upstream;
+    WeatherSocketListener listener(upstream, path);
+    const size_t descriptors = CountEntries("/proc/self/fd");
+    const size_t threads = CountEntries("/proc/self/task");
+
+    for (int client = 0; client < 10; ++client)
+    {
+        SocketWeatherServer server(path);
+        EXPECT_EQ("20;181;5.1", server.GetWeather("31.08.2018;03:00"));
+    }
+    EXPECT_TRUE(WaitFor([&]() { return CountEntries("/proc/self/fd") == descriptors; }));
+
+    // The next accept joins the workers of the closed connections
+    SocketWeatherServer server(path);
+    server.GetWeather("31.08.2018;03:00");
+    EXPECT_TRUE(WaitFor([&]() { return CountEntries("/proc/self/task") <= threads + 1; }));
+}
+
+namespace
+{
+    // Every city gets a fake server of its own, the fakes stay alive for the checks
+    CityServerFactory MakeFakeCityServers(std::mutex& mutex, std::map<std::string, FakeWeatherServer*>& servers)
+    {
+        return [&mutex, &servers](const std::string& city)
+        {
+            std::unique_ptr<FakeWeatherServer> server(new FakeWeatherServer());
+            std::lock_guard<std::mutex> lock(mutex);
+            servers[city] = server.get();
+            return std::unique_ptr<IWeatherServer>(std::move(server));
+        };
+    }
+}
+
+TEST(WeatherClient, CitiesReportAgreesWithClient)
+{
+    std::mutex mutex;
+    std::map<std::string, FakeWeatherServer*> servers;
+    SteadyClock clock;
+    CityWeatherAggregator aggregator(MakeFakeCityServers(mutex, servers), clock, 3, std::chrono::hours(1), 1024 * 1024);
+
+    const std::vector<std::string> cities = { "Kyiv", "Lviv", "Odesa", "Kharkiv", "Dnipro" };
+    const CitiesReport report = aggregator.GetReport(cities, { "31.08.2018", "01.09.2018" });
+    ASSERT_EQ(cities.size(), report.cities.size());
+
+    FakeWeatherServer server;
+    WeatherClient client;
+    for (const CityWeather& city : report.cities)
+    {
+        EXPECT_EQ(2u * g_slotsPerDay, city.temperature.count);
+        EXPECT_DOUBLE_EQ(client.GetMaximumTemperature(server, "31.08.2018"), city.temperature.maximum);
+        EXPECT_DOUBLE_EQ(client.GetMinimumTemperature(server, "01.09.2018"), city.temperature.minimum);
+    }
+    EXPECT_EQ(cities.size() * 2 * g_slotsPerDay, report.total.temperature.count);
+    EXPECT_DOUBLE_EQ(report.cities[0].windSpeed.maximum, report.total.windSpeed.maximum);
+    EXPECT_NEAR(cities.size() * report.cities[0].windDirection.sin, report.total.windDirection.sin, 1e-9);
+}
+
+TEST(WeatherClient, CitiesKeepServersAndCachesInTheirShards)
+{
+    std::mutex mutex;
+    std::map<std::string, FakeWeatherServer*> servers;
+    SteadyClock clock;
+    CityWeatherAggregator aggregator(MakeFakeCityServers(mutex, servers), clock, 4, std::chrono::hours(1), 1024 * 1024);
+
+    const std::vector<std::string> cities = { "Kyiv", "Lviv", "Odesa", "Kharkiv", "Dnipro", "Poltava" };
+    aggregator.GetReport(cities, { "31.08.2018", "01.09.2018", "02.09.2018" });
+    aggregator.GetReport(cities, { "01.09.2018", "02.09.2018" });
+    aggregator.GetReport({ "Lviv", "Kyiv" }, { "31.08.2018" });
+
+    ASSERT_EQ(cities.size(), servers.size());
+    for (const auto& server : servers)
+    {
+        EXPECT_EQ(1u, server.second->GetRoundTrips()) << server.first;
+    }
+    EXPECT_EQ(aggregator.GetShardOf("Kyiv"), aggregator.GetShardOf("Kyiv"));
+    EXPECT_LT(aggregator.GetShardOf("Kyiv"), aggregator.GetShardsCount());
+}
+
+TEST(WeatherClient, CitiesReportPassesErrors)
+{
+    std::mutex mutex;
+    std::map<std::string, FakeWeatherServer*> servers;
+    SteadyClock clock;
+    CityWeatherAggregator aggregator(MakeFakeCityServers(mutex, servers), clock, 2, std::chrono::hours(1), 1024 * 1024);
+
+    EXPECT_THROW(aggregator.GetReport({ "Kyiv", "Lviv" }, { "32.08.2018" }), std::runtime_error);
+    EXPECT_TRUE(servers.empty());
+    // The fake knows nothing about this date, so its response is empty
+    EXPECT_THROW(aggregator.GetReport({ "Kyiv", "Lviv", "Odesa" }, { "03.09.2018" }), std::runtime_error);
+    const CitiesReport report = aggregator.GetReport({ "Kyiv", "Lviv" }, { "31.08.2018", "01.09.2018" });
+    EXPECT_EQ(2u * g_slotsPerDay, report.cities[1].temperature.count);
+}
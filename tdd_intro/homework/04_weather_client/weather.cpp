@@ -0,0 +1,249 @@
+#include "weather.h"
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+const char* const g_slotTimes[g_slotsPerDay] = { "03:00", "09:00", "15:00", "21:00" };
+
+namespace
+{
+    // Some recordings of the server use ':' as the second separator
+    const std::string_view s_firstSeparators = ";";
+    const std::string_view s_secondSeparators = ";:";
+
+    const unsigned s_firstYear = 1970;
+    const double s_pi = 3.14159265358979323846;
+    const double s_fullCircle = 360.0;
+
+    bool IsLeapYear(unsigned year)
+    {
+        return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    }
+
+    unsigned DaysInMonth(unsigned year, unsigned month)
+    {
+        static const unsigned s_daysInMonth[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+        return month == 2 && IsLeapYear(year) ? 29 : s_daysInMonth[month - 1];
+    }
+
+    // Gregorian conversions of Howard Hinnant's "chrono-Compatible Low-Level Date Algorithms",
+    // years start on 1 March there, so the leap day is the last one of a year.
+    // Unsigned arithmetic is enough since no date is before s_firstYear.
+    const uint32_t s_daysBeforeEpoch = 719468;
+    const uint32_t s_daysInEra = 146097;
+    const unsigned s_maxYear = 9999;
+
+    uint32_t DaysFromCivil(unsigned year, unsigned month, unsigned day)
+    {
+        year -= month <= 2;
+        const unsigned era = year / 400;
+        const unsigned yearOfEra = year - era * 400;
+        const unsigned dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+        const unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+        return era * s_daysInEra + dayOfEra - s_daysBeforeEpoch;
+    }
+
+    void CivilFromDays(uint32_t days, unsigned& year, unsigned& month, unsigned& day)
+    {
+        days += s_daysBeforeEpoch;
+        const unsigned era = days / s_daysInEra;
+        const unsigned dayOfEra = days - era * s_daysInEra;
+        const unsigned yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+        const unsigned dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+        const unsigned shiftedMonth = (5 * dayOfYear + 2) / 153;
+        day = dayOfYear - (153 * shiftedMonth + 2) / 5 + 1;
+        month = shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9;
+        year = era * 400 + yearOfEra + (month <= 2);
+    }
+
+    // Exactly count decimal digits, no signs or spaces which from_chars would take
+    bool DecodeDigits(const char* text, size_t count, unsigned& value)
+    {
+        value = 0;
+        for (size_t index = 0; index < count; ++index)
+        {
+            const unsigned digit = static_cast<unsigned char>(text[index]) - static_cast<unsigned>('0');
+            if (digit > 9)
+            {
+                return false;
+            }
+            value = value * 10 + digit;
+        }
+        return true;
+    }
+
+    void EncodeDigits(unsigned value, size_t count, char* text)
+    {
+        for (size_t index = count; index > 0; --index)
+        {
+            text[index - 1] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        }
+    }
+
+    // Reads a number followed by one of separators and moves begin past both.
+    // Without separators the number must end the response.
+    // from_chars takes "nan" and "inf" as well, the server never sends them.
+    bool DecodeField(const char*& begin, const char* end, std::string_view separators, double& value)
+    {
+        const std::from_chars_result result = std::from_chars(begin, end, value);
+        if (result.ec != std::errc() || !std::isfinite(value))
+        {
+            return false;
+        }
+        begin = result.ptr;
+        if (separators.empty())
+        {
+            return begin == end;
+        }
+        if (begin == end || separators.find(*begin) == std::string_view::npos)
+        {
+            return false;
+        }
+        ++begin;
+        return true;
+    }
+}
+
+bool weather::DecodeDate(std::string_view date, uint32_t& days) noexcept
+{
+    unsigned day = 0;
+    unsigned month = 0;
+    unsigned year = 0;
+    if (date.size() != 10 || date[2] != '.' || date[5] != '.' ||
+        !DecodeDigits(date.data(), 2, day) || !DecodeDigits(date.data() + 3, 2, month) ||
+        !DecodeDigits(date.data() + 6, 4, year) ||
+        year < s_firstYear || month < 1 || month > 12 || day < 1 || day > DaysInMonth(year, month))
+    {
+        return false;
+    }
+
+    days = DaysFromCivil(year, month, day);
+    return true;
+}
+
+uint32_t weather::ParseDate(std::string_view date)
+{
+    uint32_t days = 0;
+    if (!DecodeDate(date, days))
+    {
+        throw std::runtime_error("malformed or impossible date: " + std::string(date));
+    }
+    return days;
+}
+
+bool weather::DecodeRequest(std::string_view request, Timestamp& timestamp) noexcept
+{
+    uint32_t days = 0;
+    if (request.size() != g_requestLength || request[10] != ';' || !DecodeDate(request.substr(0, 10), days))
+    {
+        return false;
+    }
+    const std::string_view time = request.substr(11);
+    for (unsigned short slot = 0; slot < g_slotsPerDay; ++slot)
+    {
+        if (time == g_slotTimes[slot])
+        {
+            timestamp = MakeTimestamp(days, slot);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool weather::EncodeRequest(Timestamp timestamp, char (&request)[g_requestLength]) noexcept
+{
+    unsigned year = 0;
+    unsigned month = 0;
+    unsigned day = 0;
+    CivilFromDays(GetDays(timestamp), year, month, day);
+    if (year > s_maxYear)
+    {
+        return false;
+    }
+
+    EncodeDigits(day, 2, request);
+    request[2] = '.';
+    EncodeDigits(month, 2, request + 3);
+    request[5] = '.';
+    EncodeDigits(year, 4, request + 6);
+    request[10] = ';';
+    std::memcpy(request + 11, g_slotTimes[GetSlot(timestamp)], g_requestLength - 11);
+    return true;
+}
+
+std::string weather::FormatRequest(Timestamp timestamp)
+{
+    char request[g_requestLength];
+    if (!EncodeRequest(timestamp, request))
+    {
+        throw std::runtime_error("timestamp is beyond the year " + std::to_string(s_maxYear));
+    }
+    return std::string(request, g_requestLength);
+}
+
+double weather::ToRadians(double degrees)
+{
+    return degrees * s_pi / 180.0;
+}
+
+double weather::MeanDirection(double sinSum, double cosSum)
+{
+    const double degrees = std::atan2(sinSum, cosSum) * 180.0 / s_pi;
+    return degrees < 0 ? degrees + s_fullCircle : degrees;
+}
+
+weather::ResponseStatus weather::DecodeResponse(std::string_view response, Weather& weather) noexcept
+{
+    if (response.empty())
+    {
+        return ResponseStatus::InvalidRequest;
+    }
+
+    const char* begin = response.data();
+    const char* end = begin + response.size();
+    Weather decoded;
+    if (!DecodeField(begin, end, s_firstSeparators, decoded.temperature) ||
+        !DecodeField(begin, end, s_secondSeparators, decoded.windDirection) ||
+        !DecodeField(begin, end, std::string_view(), decoded.windSpeed))
+    {
+        return ResponseStatus::Malformed;
+    }
+    if (!(decoded.windDirection >= 0 && decoded.windDirection <= g_maxWindDirection) || !(decoded.windSpeed >= 0))
+    {
+        return ResponseStatus::OutOfRange;
+    }
+
+    weather = decoded;
+    return ResponseStatus::Ok;
+}
+
+std::string weather::FormatResponse(const Weather& weather)
+{
+    // Shortest representation which reads back to the same double, so "5.1" stays "5.1"
+    char buffer[3 * 32];
+    char* end = buffer + sizeof(buffer);
+    char* position = std::to_chars(buffer, end, weather.temperature).ptr;
+    *position++ = ';';
+    position = std::to_chars(position, end, weather.windDirection).ptr;
+    *position++ = ';';
+    position = std::to_chars(position, end, weather.windSpeed).ptr;
+    return std::string(buffer, position);
+}
+
+Weather weather::ParseResponse(std::string_view response)
+{
+    Weather weather;
+    switch (DecodeResponse(response, weather))
+    {
+    case ResponseStatus::Ok:
+        return weather;
+    case ResponseStatus::InvalidRequest:
+        throw std::runtime_error("invalid request");
+    case ResponseStatus::OutOfRange:
+        throw std::runtime_error("value out of range in response: " + std::string(response));
+    default:
+        throw std::runtime_error("malformed response: " + std::string(response));
+    }
+}
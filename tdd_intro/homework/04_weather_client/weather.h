@@ -0,0 +1,71 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+struct Weather
+{
+    double temperature;
+    double windDirection;
+    double windSpeed;
+};
+
+// Server keeps weather only for these times of every date
+const unsigned short g_slotsPerDay = 4;
+extern const char* const g_slotTimes[g_slotsPerDay];
+
+// Reading key: days since 01.01.1970 above g_slotBits bits of the slot, so readings sort by time.
+// Everything but IWeatherServer works with these, requests are only made at the server boundary.
+typedef uint32_t Timestamp;
+const unsigned short g_slotBits = 2;
+static_assert(1u << g_slotBits == g_slotsPerDay, "slot must take all values of its bits");
+// "31.08.2018;03:00"
+const size_t g_requestLength = 16;
+
+namespace weather
+{
+    // Days since 01.01.1970 of a "31.08.2018" date, false for malformed or impossible dates
+    bool DecodeDate(std::string_view date, uint32_t& days) noexcept;
+    // Same, but throws std::runtime_error
+    uint32_t ParseDate(std::string_view date);
+    inline Timestamp MakeTimestamp(uint32_t days, unsigned short slot)
+    {
+        return days << g_slotBits | slot;
+    }
+    inline uint32_t GetDays(Timestamp timestamp)
+    {
+        return timestamp >> g_slotBits;
+    }
+    inline unsigned short GetSlot(Timestamp timestamp)
+    {
+        return static_cast<unsigned short>(timestamp & (g_slotsPerDay - 1));
+    }
+
+    // Timestamp of a "31.08.2018;03:00" request, false if the date or time is not a valid one
+    bool DecodeRequest(std::string_view request, Timestamp& timestamp) noexcept;
+    // Request of the timestamp, false if its year does not fit in four digits
+    bool EncodeRequest(Timestamp timestamp, char (&request)[g_requestLength]) noexcept;
+    // Same, but throws std::runtime_error
+    std::string FormatRequest(Timestamp timestamp);
+
+    double ToRadians(double degrees);
+    // Mean direction in 0..360 of the directions whose sines and cosines were summed
+    double MeanDirection(double sinSum, double cosSum);
+    enum class ResponseStatus
+    {
+        Ok,
+        InvalidRequest, // empty response, the server knows nothing about the date or time
+        Malformed,      // not three finite numbers separated by ';'
+        OutOfRange      // wind direction is not in 0..359 or wind speed is negative
+    };
+
+    const double g_maxWindDirection = 359;
+
+    // Parses "20;181;5.1" without allocations and independent of the locale.
+    // weather is changed only when Ok is returned.
+    ResponseStatus DecodeResponse(std::string_view response, Weather& weather) noexcept;
+    // Same, but throws std::runtime_error for anything but a valid response
+    Weather ParseResponse(std::string_view response);
+    // Response the server would give, ParseResponse reads the same values back
+    std::string FormatResponse(const Weather& weather);
+}
@@ -0,0 +1,122 @@
+#include "weatherclient.h"
+#include "batchweatherserveradapter.h"
+#include <algorithm>
+#include <cmath>
+
+std::vector<Timestamp> weather::MakeDaysTimestamps(const std::vector<std::string>& dates)
+{
+    std::vector<Timestamp> timestamps;
+    timestamps.reserve(dates.size() * g_slotsPerDay);
+    for (const std::string& date : dates)
+    {
+        const uint32_t days = ParseDate(date);
+        for (unsigned short slot = 0; slot < g_slotsPerDay; ++slot)
+        {
+            timestamps.push_back(MakeTimestamp(days, slot));
+        }
+    }
+    return timestamps;
+}
+
+std::vector<Weather> weather::GetReadings(IWeatherServer& server, const std::vector<Timestamp>& timestamps)
+{
+    std::vector<std::string> requests;
+    requests.reserve(timestamps.size());
+    for (Timestamp timestamp : timestamps)
+    {
+        requests.push_back(FormatRequest(timestamp));
+    }
+
+    const std::vector<std::string> responses = GetWeatherBatch(server, requests);
+    std::vector<Weather> weather;
+    weather.reserve(responses.size());
+    for (const std::string& response : responses)
+    {
+        weather.push_back(ParseResponse(response));
+    }
+    return weather;
+}
+
+void weather::GetDayWeather(IWeatherServer& server, uint32_t days, Weather day[g_slotsPerDay])
+{
+    std::vector<Timestamp> timestamps;
+    for (unsigned short slot = 0; slot < g_slotsPerDay; ++slot)
+    {
+        timestamps.push_back(MakeTimestamp(days, slot));
+    }
+    const std::vector<Weather> readings = GetReadings(server, timestamps);
+    std::copy(readings.begin(), readings.end(), day);
+}
+
+std::vector<Weather> weather::GetDaysWeather(IWeatherServer& server, const std::vector<std::string>& dates)
+{
+    return GetReadings(server, MakeDaysTimestamps(dates));
+}
+
+double WeatherClient::GetAverageTemperature(IWeatherServer& server, const std::string& date)
+{
+    Weather day[g_slotsPerDay];
+    weather::GetDayWeather(server, weather::ParseDate(date), day);
+
+    double sum = 0;
+    for (const Weather& weather : day)
+    {
+        sum += weather.temperature;
+    }
+    return sum / g_slotsPerDay;
+}
+
+double WeatherClient::GetMinimumTemperature(IWeatherServer& server, const std::string& date)
+{
+    Weather day[g_slotsPerDay];
+    weather::GetDayWeather(server, weather::ParseDate(date), day);
+
+    double minimum = day[0].temperature;
+    for (const Weather& weather : day)
+    {
+        minimum = std::min(minimum, weather.temperature);
+    }
+    return minimum;
+}
+
+double WeatherClient::GetMaximumTemperature(IWeatherServer& server, const std::string& date)
+{
+    Weather day[g_slotsPerDay];
+    weather::GetDayWeather(server, weather::ParseDate(date), day);
+
+    double maximum = day[0].temperature;
+    for (const Weather& weather : day)
+    {
+        maximum = std::max(maximum, weather.temperature);
+    }
+    return maximum;
+}
+
+double WeatherClient::GetAverageWindDirection(IWeatherServer& server, const std::string& date)
+{
+    Weather day[g_slotsPerDay];
+    weather::GetDayWeather(server, weather::ParseDate(date), day);
+
+    double sinSum = 0;
+    double cosSum = 0;
+    for (const Weather& weather : day)
+    {
+        const double radians = weather::ToRadians(weather.windDirection);
+        sinSum += std::sin(radians);
+        cosSum += std::cos(radians);
+    }
+    return weather::MeanDirection(sinSum, cosSum);
+}
+
+double WeatherClient::GetMaximumWindSpeed(IWeatherServer& server, const std::string& date)
+{
+    Weather day[g_slotsPerDay];
+    weather::GetDayWeather(server, weather::ParseDate(date), day);
+
+    double maximum = day[0].windSpeed;
+    for (const Weather& weather : day)
+    {
+        maximum = std::max(maximum, weather.windSpeed);
+    }
+    return maximum;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include "iweatherclient.h"
+#include "weather.h"
+#include <vector>
+
+class WeatherClient : public IWeatherClient
+{
+public:
+    double GetAverageTemperature(IWeatherServer& server, const std::string& date) override;
+    double GetMinimumTemperature(IWeatherServer& server, const std::string& date) override;
+    double GetMaximumTemperature(IWeatherServer& server, const std::string& date) override;
+    // Mean of the directions on a circle, so 350 and 10 give 0, not 180
+    double GetAverageWindDirection(IWeatherServer& server, const std::string& date) override;
+    double GetMaximumWindSpeed(IWeatherServer& server, const std::string& date) override;
+};
+
+namespace weather
+{
+    // Timestamps of all slots of every date, g_slotsPerDay items per date.
+    // Throws std::runtime_error for an invalid date before anything is asked from a server.
+    std::vector<Timestamp> MakeDaysTimestamps(const std::vector<std::string>& dates);
+
+    // Weather of the readings, in one round trip when the server supports batches.
+    // Requests are only made here, right before they are sent.
+    std::vector<Weather> GetReadings(IWeatherServer& server, const std::vector<Timestamp>& timestamps);
+    // Weather of all slots of the date
+    void GetDayWeather(IWeatherServer& server, uint32_t days, Weather day[g_slotsPerDay]);
+    // Weather of all slots of every date, g_slotsPerDay items per date, in one round trip as well
+    std::vector<Weather> GetDaysWeather(IWeatherServer& server, const std::vector<std::string>& dates);
+}
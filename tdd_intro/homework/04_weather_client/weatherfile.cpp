@@ -0,0 +1,352 @@
+#include "weatherfile.h"
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define WEATHER_HAS_MMAP
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    const char s_magic[8] = { 'W', 'E', 'A', 'T', 'H', 'E', 'R', '\0' };
+    const uint32_t s_version = 1;
+    const uint32_t s_initialCapacity = 1024;
+    // Index slots per record, keeps probe sequences short
+    const uint32_t s_indexSlotsPerRecord = 2;
+    // Index slot value for no record, others are record number plus one
+    const uint32_t s_emptySlot = 0;
+
+    static_assert(std::atomic<uint32_t>::is_always_lock_free && sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+                  "index slots and count are shared with other processes as plain 32-bit words");
+
+    struct FileHeader
+    {
+        char magic[8];
+        uint32_t version;
+        // Power of two
+        uint32_t capacity;
+        // Published after the record and its index slot
+        uint32_t count;
+        uint32_t reserved;
+    };
+
+    struct FileRecord
+    {
+        Timestamp timestamp;
+        uint32_t reserved;
+        double temperature;
+        double windDirection;
+        double windSpeed;
+    };
+
+    size_t GetFileSize(uint32_t capacity)
+    {
+        return sizeof(FileHeader) + capacity * (sizeof(FileRecord) + s_indexSlotsPerRecord * sizeof(uint32_t));
+    }
+
+    FileHeader& HeaderOf(char* data)
+    {
+        return *reinterpret_cast<FileHeader*>(data);
+    }
+
+    std::atomic<uint32_t>& CountOf(char* data)
+    {
+        return *reinterpret_cast<std::atomic<uint32_t>*>(&HeaderOf(data).count);
+    }
+
+    FileRecord* RecordsOf(char* data)
+    {
+        return reinterpret_cast<FileRecord*>(data + sizeof(FileHeader));
+    }
+
+    std::atomic<uint32_t>* IndexOf(char* data, uint32_t capacity)
+    {
+        return reinterpret_cast<std::atomic<uint32_t>*>(data + sizeof(FileHeader) + capacity * sizeof(FileRecord));
+    }
+
+    uint32_t FirstSlot(Timestamp timestamp, uint32_t slotsMask)
+    {
+        // Fibonacci hashing, neighbouring timestamps land far from each other
+        return (timestamp * 2654435761u) & slotsMask;
+    }
+
+    // Number of the record with the timestamp, capacity if there is none
+    uint32_t FindRecord(char* data, uint32_t capacity, Timestamp timestamp)
+    {
+        const std::atomic<uint32_t>* index = IndexOf(data, capacity);
+        const FileRecord* records = RecordsOf(data);
+        const uint32_t slotsMask = capacity * s_indexSlotsPerRecord - 1;
+        for (uint32_t slot = FirstSlot(timestamp, slotsMask), probes = 0; probes <= slotsMask;
+             slot = (slot + 1) & slotsMask, ++probes)
+        {
+            const uint32_t value = index[slot].load(std::memory_order_acquire);
+            if (value == s_emptySlot)
+            {
+                break;
+            }
+            if (value - 1 < capacity && records[value - 1].timestamp == timestamp)
+            {
+                return value - 1;
+            }
+        }
+        return capacity;
+    }
+
+    void AddToIndex(char* data, uint32_t capacity, Timestamp timestamp, uint32_t record)
+    {
+        std::atomic<uint32_t>* index = IndexOf(data, capacity);
+        const uint32_t slotsMask = capacity * s_indexSlotsPerRecord - 1;
+        uint32_t slot = FirstSlot(timestamp, slotsMask);
+        while (index[slot].load(std::memory_order_relaxed) != s_emptySlot)
+        {
+            slot = (slot + 1) & slotsMask;
+        }
+        index[slot].store(record + 1, std::memory_order_release);
+    }
+
+#ifdef WEATHER_HAS_MMAP
+    /*
+     * Writes a complete file with the records next to path and renames it over path,
+     * so processes which have the old file mapped never see a half written one.
+     */
+    void ReplaceFile(const std::string& path, uint32_t capacity, const FileRecord* records, uint32_t count)
+    {
+        const std::string temporaryPath = path + ".tmp";
+        const int fd = open(temporaryPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+        {
+            throw std::runtime_error("can't create " + temporaryPath);
+        }
+        const size_t size = GetFileSize(capacity);
+        void* mapping = MAP_FAILED;
+        if (ftruncate(fd, static_cast<off_t>(size)) == 0)
+        {
+            mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        if (mapping == MAP_FAILED)
+        {
+            close(fd);
+            unlink(temporaryPath.c_str());
+            throw std::runtime_error("can't map " + temporaryPath);
+        }
+
+        // The new file is zero filled, so all index slots are empty
+        char* data = static_cast<char*>(mapping);
+        FileHeader& header = HeaderOf(data);
+        std::memcpy(header.magic, s_magic, sizeof(s_magic));
+        header.version = s_version;
+        header.capacity = capacity;
+        header.count = count;
+        if (count != 0)
+        {
+            std::memcpy(RecordsOf(data), records, count * sizeof(FileRecord));
+        }
+        for (uint32_t record = 0; record < count; ++record)
+        {
+            AddToIndex(data, capacity, records[record].timestamp, record);
+        }
+
+        munmap(mapping, size);
+        const bool synced = fsync(fd) == 0;
+        close(fd);
+        if (!synced || rename(temporaryPath.c_str(), path.c_str()) != 0)
+        {
+            unlink(temporaryPath.c_str());
+            throw std::runtime_error("can't replace " + path);
+        }
+    }
+#endif
+}
+
+WeatherFile::WeatherFile(const std::string& path, Mode mode)
+    : m_path(path)
+    , m_mode(mode)
+    , m_fd(-1)
+    , m_lockFd(-1)
+    , m_data(nullptr)
+    , m_dataSize(0)
+    , m_capacity(0)
+{
+#ifdef WEATHER_HAS_MMAP
+    try
+    {
+        if (mode == Mode::ReadWrite)
+        {
+            const std::string lockPath = path + ".lock";
+            m_lockFd = open(lockPath.c_str(), O_RDWR | O_CREAT, 0644);
+            if (m_lockFd < 0 || flock(m_lockFd, LOCK_EX | LOCK_NB) != 0)
+            {
+                throw std::runtime_error(path + " is opened for writing by another process");
+            }
+
+            struct stat status;
+            if (stat(path.c_str(), &status) != 0)
+            {
+                ReplaceFile(path, s_initialCapacity, nullptr, 0);
+            }
+        }
+        Map();
+    }
+    catch (...)
+    {
+        Unlock();
+        throw;
+    }
+#else
+    throw std::runtime_error("memory mapped weather files are not supported on this platform");
+#endif
+}
+
+WeatherFile::~WeatherFile()
+{
+    Unmap();
+    Unlock();
+}
+
+bool WeatherFile::Find(Timestamp timestamp, Weather& weather) const
+{
+    const uint32_t record = FindRecord(m_data, m_capacity, timestamp);
+    if (record == m_capacity)
+    {
+        return false;
+    }
+    const FileRecord& found = RecordsOf(m_data)[record];
+    weather.temperature = found.temperature;
+    weather.windDirection = found.windDirection;
+    weather.windSpeed = found.windSpeed;
+    return true;
+}
+
+void WeatherFile::Append(Timestamp timestamp, const Weather& weather)
+{
+    if (!IsWritable())
+    {
+        throw std::runtime_error(m_path + " is opened read-only");
+    }
+    if (FindRecord(m_data, m_capacity, timestamp) != m_capacity)
+    {
+        return;
+    }
+    if (CountOf(m_data).load(std::memory_order_relaxed) == m_capacity)
+    {
+        Grow();
+    }
+
+    const uint32_t count = CountOf(m_data).load(std::memory_order_relaxed);
+    FileRecord& record = RecordsOf(m_data)[count];
+    record.timestamp = timestamp;
+    record.temperature = weather.temperature;
+    record.windDirection = weather.windDirection;
+    record.windSpeed = weather.windSpeed;
+    AddToIndex(m_data, m_capacity, timestamp, count);
+    CountOf(m_data).store(count + 1, std::memory_order_release);
+}
+
+size_t WeatherFile::GetSize() const
+{
+    return CountOf(m_data).load(std::memory_order_acquire);
+}
+
+bool WeatherFile::IsWritable() const
+{
+    return m_mode == Mode::ReadWrite;
+}
+
+#ifdef WEATHER_HAS_MMAP
+bool WeatherFile::Refresh()
+{
+    struct stat current;
+    struct stat mapped;
+    if (stat(m_path.c_str(), &current) != 0 || fstat(m_fd, &mapped) != 0 ||
+        (current.st_ino == mapped.st_ino && current.st_dev == mapped.st_dev))
+    {
+        return false;
+    }
+    Unmap();
+    Map();
+    return true;
+}
+
+void WeatherFile::Map()
+{
+    m_fd = open(m_path.c_str(), IsWritable() ? O_RDWR : O_RDONLY);
+    FileHeader header;
+    struct stat status;
+    if (m_fd < 0 || fstat(m_fd, &status) != 0 ||
+        pread(m_fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+        std::memcmp(header.magic, s_magic, sizeof(s_magic)) != 0 || header.version != s_version ||
+        header.capacity == 0 || (header.capacity & (header.capacity - 1)) != 0 ||
+        static_cast<size_t>(status.st_size) != GetFileSize(header.capacity))
+    {
+        Unmap();
+        throw std::runtime_error(m_path + " is not a weather file");
+    }
+
+    m_dataSize = GetFileSize(header.capacity);
+    void* mapping = mmap(nullptr, m_dataSize, IsWritable() ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, m_fd, 0);
+    if (mapping == MAP_FAILED)
+    {
+        Unmap();
+        throw std::runtime_error("can't map " + m_path);
+    }
+    m_data = static_cast<char*>(mapping);
+    m_capacity = header.capacity;
+}
+
+void WeatherFile::Unmap()
+{
+    if (m_data != nullptr)
+    {
+        munmap(m_data, m_dataSize);
+        m_data = nullptr;
+    }
+    if (m_fd >= 0)
+    {
+        close(m_fd);
+        m_fd = -1;
+    }
+}
+
+void WeatherFile::Unlock()
+{
+    // Closing the descriptor releases the lock
+    if (m_lockFd >= 0)
+    {
+        close(m_lockFd);
+        m_lockFd = -1;
+    }
+}
+
+void WeatherFile::Grow()
+{
+    ReplaceFile(m_path, m_capacity * 2, RecordsOf(m_data), CountOf(m_data).load(std::memory_order_relaxed));
+    Refresh();
+}
+#else
+bool WeatherFile::Refresh()
+{
+    return false;
+}
+
+void WeatherFile::Map()
+{
+}
+
+void WeatherFile::Unmap()
+{
+}
+
+void WeatherFile::Unlock()
+{
+}
+
+void WeatherFile::Grow()
+{
+}
+#endif
@@ -0,0 +1,56 @@
+#pragma once
+#include "weather.h"
+#include <string>
+
+/*
+ * Readings kept in a file which is memory mapped, so opening it costs the same for any history.
+ * The file holds a header, an array of fixed size records in the order they were added
+ * and an open addressing index from timestamps to record numbers.
+ *
+ * Any number of processes may map the file read-only while one of them appends to it.
+ * A record is written before its index slot is published, so readers see complete readings only.
+ * When the file is full, the writer builds a twice larger copy and renames it over the old one;
+ * readers keep the old mapping until they call Refresh.
+ *
+ * Needs mmap, on other platforms the constructor throws.
+ */
+class WeatherFile
+{
+public:
+    enum class Mode
+    {
+        ReadOnly,
+        ReadWrite   // creates the file if needed, only one writer at a time
+    };
+
+    // Throws std::runtime_error if the file can't be opened or is not a weather file
+    WeatherFile(const std::string& path, Mode mode);
+    ~WeatherFile();
+
+    WeatherFile(const WeatherFile&) = delete;
+    WeatherFile& operator=(const WeatherFile&) = delete;
+
+    bool Find(Timestamp timestamp, Weather& weather) const;
+    // Readings never change, so a known timestamp is left as is.
+    // Throws std::runtime_error for a read-only file.
+    void Append(Timestamp timestamp, const Weather& weather);
+
+    size_t GetSize() const;
+    bool IsWritable() const;
+    // Maps the file again if a writer has replaced it since, returns whether it did
+    bool Refresh();
+
+private:
+    void Map();
+    void Unmap();
+    void Unlock();
+    void Grow();
+
+    std::string m_path;
+    Mode m_mode;
+    int m_fd;
+    int m_lockFd;
+    char* m_data;
+    size_t m_dataSize;
+    uint32_t m_capacity;
+};
@@ -0,0 +1,190 @@
+#include "weatherseries.h"
+#include "weatherclient.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+    // A year of readings is less than 6 blocks
+    const size_t s_blockSize = 256;
+
+    void AddToAggregate(WeatherSeries::Aggregate& aggregate, double value)
+    {
+        const WeatherSeries::Aggregate single = { 1, value, value, value };
+        weather::MergeStats(aggregate, single);
+    }
+
+    // Readings before the first whole block of [first, last) and from the end of the last one
+    void SplitRange(size_t first, size_t last, size_t& head, size_t& tail)
+    {
+        head = std::min(last, (first + s_blockSize - 1) / s_blockSize * s_blockSize);
+        tail = std::max(head, last / s_blockSize * s_blockSize);
+    }
+
+    size_t FloorLog2(size_t value)
+    {
+        size_t log = 0;
+        while (value >>= 1)
+        {
+            ++log;
+        }
+        return log;
+    }
+}
+
+void WeatherSeries::Append(Timestamp timestamp, const Weather& weather)
+{
+    if (!m_timestamps.empty() && timestamp <= m_timestamps.back())
+    {
+        throw std::runtime_error("readings must be appended in order of time");
+    }
+
+    if (m_timestamps.size() % s_blockSize == 0)
+    {
+        m_windDirectionSums.push_back(m_windDirectionSums.empty() ? DirectionSums() : m_windDirectionSums.back());
+    }
+    m_timestamps.push_back(timestamp);
+    m_temperatures.push_back(weather.temperature);
+    m_windDirections.push_back(weather.windDirection);
+    m_windSpeeds.push_back(weather.windSpeed);
+
+    AddToIndex(m_temperatureIndex, weather.temperature);
+    AddToIndex(m_windSpeedIndex, weather.windSpeed);
+    const double radians = weather::ToRadians(weather.windDirection);
+    m_windDirectionSums.back().sin += std::sin(radians);
+    m_windDirectionSums.back().cos += std::cos(radians);
+}
+
+size_t WeatherSeries::GetSize() const
+{
+    return m_timestamps.size();
+}
+
+Timestamp WeatherSeries::GetFirstTimestamp() const
+{
+    return m_timestamps.front();
+}
+
+Timestamp WeatherSeries::GetLastTimestamp() const
+{
+    return m_timestamps.back();
+}
+
+WeatherSeries::Aggregate WeatherSeries::GetTemperature(Timestamp from, Timestamp to) const
+{
+    size_t first = 0;
+    size_t last = 0;
+    FindRange(from, to, first, last);
+    return AggregateColumn(m_temperatures, m_temperatureIndex, first, last);
+}
+
+WeatherSeries::Aggregate WeatherSeries::GetWindSpeed(Timestamp from, Timestamp to) const
+{
+    size_t first = 0;
+    size_t last = 0;
+    FindRange(from, to, first, last);
+    return AggregateColumn(m_windSpeeds, m_windSpeedIndex, first, last);
+}
+
+double WeatherSeries::GetAverageWindDirection(Timestamp from, Timestamp to) const
+{
+    size_t first = 0;
+    size_t last = 0;
+    FindRange(from, to, first, last);
+
+    // Partial blocks at the ends go through the kernel, whole blocks come from the running sums
+    size_t head = 0;
+    size_t tail = 0;
+    SplitRange(first, last, head, tail);
+    DirectionSums sum = weather::SumDirections(m_windDirections.data() + first, head - first);
+    const DirectionSums tailSum = weather::SumDirections(m_windDirections.data() + tail, last - tail);
+    sum.sin += tailSum.sin;
+    sum.cos += tailSum.cos;
+    if (head < tail)
+    {
+        const DirectionSums& through = m_windDirectionSums[tail / s_blockSize - 1];
+        sum.sin += through.sin;
+        sum.cos += through.cos;
+        if (head > 0)
+        {
+            const DirectionSums& before = m_windDirectionSums[head / s_blockSize - 1];
+            sum.sin -= before.sin;
+            sum.cos -= before.cos;
+        }
+    }
+    return weather::MeanDirection(sum.sin, sum.cos);
+}
+
+void WeatherSeries::FindRange(Timestamp from, Timestamp to, size_t& first, size_t& last) const
+{
+    first = std::lower_bound(m_timestamps.begin(), m_timestamps.end(), from) - m_timestamps.begin();
+    last = std::max(first, static_cast<size_t>(std::lower_bound(m_timestamps.begin(), m_timestamps.end(), to) - m_timestamps.begin()));
+}
+
+void WeatherSeries::AddToIndex(BlockIndex& index, double value)
+{
+    if (index.blocks.empty() || index.blocks.back().count == s_blockSize)
+    {
+        index.blocks.push_back(Aggregate());
+        index.sums.push_back(index.sums.empty() ? 0 : index.sums.back());
+    }
+    AddToAggregate(index.blocks.back(), value);
+    index.sums.back() += value;
+    if (index.blocks.back().count != s_blockSize)
+    {
+        return;
+    }
+
+    // The full block ends a run of 2^(level + 1) blocks at every level there are enough blocks for
+    const size_t fullBlocks = index.blocks.size();
+    for (size_t level = 0; size_t(2) << level <= fullBlocks; ++level)
+    {
+        if (index.extremes.size() == level)
+        {
+            index.extremes.emplace_back();
+        }
+        const size_t half = size_t(1) << level;
+        const size_t start = fullBlocks - 2 * half;
+        const std::vector<Aggregate>& lower = level == 0 ? index.blocks : index.extremes[level - 1];
+        Aggregate extremes = lower[start];
+        weather::MergeStats(extremes, lower[start + half]);
+        index.extremes[level].push_back(extremes);
+    }
+}
+
+WeatherSeries::Aggregate WeatherSeries::AggregateColumn(const std::vector<double>& column, const BlockIndex& index,
+                                                        size_t first, size_t last)
+{
+    size_t head = 0;
+    size_t tail = 0;
+    SplitRange(first, last, head, tail);
+    Aggregate aggregate = weather::ComputeStats(column.data() + first, head - first);
+    weather::MergeStats(aggregate, weather::ComputeStats(column.data() + tail, last - tail));
+    if (head == tail)
+    {
+        return aggregate;
+    }
+
+    const size_t firstBlock = head / s_blockSize;
+    const size_t lastBlock = tail / s_blockSize;
+    // Two runs which cover the blocks, they may overlap as extremes don't mind
+    const size_t level = FloorLog2(lastBlock - firstBlock);
+    const std::vector<Aggregate>& runs = level == 0 ? index.blocks : index.extremes[level - 1];
+    Aggregate blocks = runs[firstBlock];
+    weather::MergeStats(blocks, runs[lastBlock - (size_t(1) << level)]);
+    blocks.count = tail - head;
+    blocks.sum = index.sums[lastBlock - 1] - (firstBlock == 0 ? 0 : index.sums[firstBlock - 1]);
+    weather::MergeStats(aggregate, blocks);
+    return aggregate;
+}
+
+void weather::LoadSeries(IWeatherServer& server, const std::vector<std::string>& dates, WeatherSeries& series)
+{
+    const std::vector<Timestamp> timestamps = MakeDaysTimestamps(dates);
+    const std::vector<Weather> readings = GetReadings(server, timestamps);
+    for (size_t index = 0; index < readings.size(); ++index)
+    {
+        series.Append(timestamps[index], readings[index]);
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include "weather.h"
+#include "iweatherserver.h"
+#include "statskernels.h"
+#include <vector>
+
+/*
+ * Readings of many dates, each field kept in its own contiguous array.
+ * Every s_blockSize readings get a summary of the block, so a query scans only the readings
+ * of the partial blocks at its two ends. Whole blocks between them take the same time however many:
+ * sums come from running totals over the blocks, extremes from a sparse table of the block summaries,
+ * where any run of blocks is covered by two runs of a power of two length.
+ */
+class WeatherSeries
+{
+public:
+    typedef SampleStats Aggregate;
+
+    // Readings must come in increasing order of timestamps, throws std::runtime_error otherwise
+    void Append(Timestamp timestamp, const Weather& weather);
+
+    size_t GetSize() const;
+    Timestamp GetFirstTimestamp() const;
+    Timestamp GetLastTimestamp() const;
+
+    // Over readings with timestamps in [from, to)
+    Aggregate GetTemperature(Timestamp from, Timestamp to) const;
+    Aggregate GetWindSpeed(Timestamp from, Timestamp to) const;
+    // Mean on a circle, like WeatherClient does for a single date; 0 for an empty range
+    double GetAverageWindDirection(Timestamp from, Timestamp to) const;
+
+private:
+    struct BlockIndex
+    {
+        // The last one fills up with readings
+        std::vector<Aggregate> blocks;
+        // Sum of the readings of all blocks up to each one, itself included
+        std::vector<double> sums;
+        // Minimum and maximum over 2^(level + 1) full blocks from each one
+        std::vector<std::vector<Aggregate>> extremes;
+    };
+
+    // Indexes of the first reading at or after from and of the first one at or after to
+    void FindRange(Timestamp from, Timestamp to, size_t& first, size_t& last) const;
+    static void AddToIndex(BlockIndex& index, double value);
+    static Aggregate AggregateColumn(const std::vector<double>& column, const BlockIndex& index, size_t first, size_t last);
+
+    std::vector<Timestamp> m_timestamps;
+    std::vector<double> m_temperatures;
+    std::vector<double> m_windDirections;
+    std::vector<double> m_windSpeeds;
+
+    BlockIndex m_temperatureIndex;
+    BlockIndex m_windSpeedIndex;
+    // Sums of all blocks up to each one, itself included
+    std::vector<DirectionSums> m_windDirectionSums;
+};
+
+namespace weather
+{
+    // Appends all slots of the dates, which must be in increasing order
+    void LoadSeries(IWeatherServer& server, const std::vector<std::string>& dates, WeatherSeries& series);
+}
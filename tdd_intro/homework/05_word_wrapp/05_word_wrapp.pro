@@ -1,9 +1,24 @@
 include(../../gtest.pri)
 
 TEMPLATE = app
-CONFIG += console c++11
+CONFIG += console c++17
 CONFIG -= app_bundle
 CONFIG -= qt
 
 SOURCES += \
-    test.cpp
+    test.cpp \
+    benchmark.cpp \
+    wordwrap.cpp \
+    breakfinder.cpp \
+    unicode.cpp \
+    optimalfit.cpp \
+    documentwrapper.cpp \
+    textlayout.cpp
+
+HEADERS += \
+    wordwrap.h \
+    breakfinder.h \
+    unicode.h \
+    optimalfit.h \
+    documentwrapper.h \
+    textlayout.h
@@ -0,0 +1,270 @@
+// Performance checks for the word wrapper.
+// They are disabled by default, run them with --gtest_also_run_disabled_tests --gtest_filter=*Benchmark*
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include "wordwrap.h"
+#include "documentwrapper.h"
+#include "textlayout.h"
+
+namespace
+{
+    const size_t s_benchmarkBytes = 64 * 1024 * 1024;
+    const size_t s_lineLimit = 80;
+
+    // Words of 1 to 12 letters, a paragraph break every 50 words or so
+    std::string MakeText(size_t size)
+    {
+        std::string text;
+        text.reserve(size + 16);
+        uint64_t seed = 1;
+        while (text.size() < size)
+        {
+            seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+            text.append(1 + (seed >> 33) % 12, 'a' + (seed >> 40) % 26);
+            text += (seed >> 50) % 50 == 0 ? '\n' : ' ';
+        }
+        return text;
+    }
+
+    // Same words in Cyrillic, two bytes per letter
+    std::string ToCyrillic(const std::string& text)
+    {
+        std::string cyrillic;
+        cyrillic.reserve(text.size() * 2);
+        for (char symbol : text)
+        {
+            if (symbol >= 'a' && symbol <= 'z')
+            {
+                // U+0430 and on
+                const unsigned character = 0x430 + (symbol - 'a');
+                cyrillic += static_cast<char>(0xC0 | character >> 6);
+                cyrillic += static_cast<char>(0x80 | (character & 0x3F));
+            }
+            else
+            {
+                cyrillic += symbol;
+            }
+        }
+        return cyrillic;
+    }
+
+    template<typename Wrapper>
+    size_t CountLines(Wrapper wrapper)
+    {
+        size_t lines = 0;
+        std::string_view line;
+        while (wrapper.Next(line))
+        {
+            ++lines;
+        }
+        return lines;
+    }
+
+    template<typename Action>
+    double MeasureSeconds(Action action)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        action();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Best of several runs, for differences smaller than the noise of one run
+    template<typename Action>
+    double MeasureBestSeconds(Action action)
+    {
+        double best = MeasureSeconds(action);
+        for (int run = 1; run < 5; ++run)
+        {
+            best = std::min(best, MeasureSeconds(action));
+        }
+        return best;
+    }
+}
+
+TEST(WordWrapBenchmark, DISABLED_Throughput)
+{
+    const std::string text = MakeText(s_benchmarkBytes);
+    const double megabytes = text.size() / (1024.0 * 1024.0);
+
+    size_t copiedLines = 0;
+    const double copied = MeasureSeconds([&]() { copiedLines = wrap::WrapText(text, s_lineLimit).size(); });
+
+    size_t streamedLines = 0;
+    size_t streamedBytes = 0;
+    const double streamed = MeasureSeconds([&]()
+    {
+        wrap::ForEachLine(text, s_lineLimit, [&](std::string_view line)
+        {
+            ++streamedLines;
+            streamedBytes += line.size();
+        });
+    });
+
+    EXPECT_EQ(copiedLines, streamedLines);
+    EXPECT_LT(streamedBytes, text.size());
+    std::cout << "vector of strings: " << megabytes / copied << " MB/sec" << std::endl;
+    std::cout << "string_view lines: " << megabytes / streamed << " MB/sec, speedup " << copied / streamed << std::endl;
+}
+
+TEST(WordWrapBenchmark, DISABLED_BreakKernels)
+{
+    const std::string text = MakeText(s_benchmarkBytes);
+    const double gigabytes = text.size() / (1024.0 * 1024.0 * 1024.0);
+
+    const std::pair<wrap::BreakKernel, const char*> kernels[] = {
+        { wrap::BreakKernel::Scalar, "scalar" },
+        { wrap::BreakKernel::Sse2, "sse2" },
+        { wrap::BreakKernel::Avx2, "avx2" }
+    };
+    const size_t limits[] = { 20, 40, 80, 160, 640 };
+    for (size_t limit : limits)
+    {
+        double scalar = 0;
+        for (const auto& kernel : kernels)
+        {
+            if (!wrap::IsBreakKernelSupported(kernel.first))
+            {
+                continue;
+            }
+
+            size_t lines = 0;
+            const double seconds = MeasureSeconds([&]()
+            {
+                wrap::LineWrapper wrapper(text, limit, kernel.first);
+                std::string_view line;
+                while (wrapper.Next(line))
+                {
+                    ++lines;
+                }
+            });
+            scalar = kernel.first == wrap::BreakKernel::Scalar ? seconds : scalar;
+            EXPECT_NE(0u, lines);
+            std::cout << "width " << limit << ", " << kernel.second << ": " << gigabytes / seconds
+                      << " GB/sec, speedup " << scalar / seconds << std::endl;
+        }
+    }
+}
+
+TEST(WordWrapBenchmark, DISABLED_ColumnWrapping)
+{
+    const std::string text = MakeText(s_benchmarkBytes);
+    const std::string cyrillic = ToCyrillic(MakeText(s_benchmarkBytes / 2));
+    const double gigabytes = text.size() / (1024.0 * 1024.0 * 1024.0);
+    const double cyrillicGigabytes = cyrillic.size() / (1024.0 * 1024.0 * 1024.0);
+
+    size_t byteLines = 0;
+    size_t columnLines = 0;
+    size_t cyrillicLines = 0;
+    const double bytes = MeasureBestSeconds([&]() { byteLines = CountLines(wrap::LineWrapper(text, s_lineLimit)); });
+    const double columns = MeasureBestSeconds([&]() { columnLines = CountLines(wrap::ColumnWrapper(text, s_lineLimit)); });
+    const double unicode = MeasureSeconds([&]() { cyrillicLines = CountLines(wrap::ColumnWrapper(cyrillic, s_lineLimit)); });
+
+    EXPECT_EQ(byteLines, columnLines);
+    EXPECT_EQ(CountLines(wrap::LineWrapper(MakeText(s_benchmarkBytes / 2), s_lineLimit)), cyrillicLines);
+    std::cout << "ascii by bytes: " << gigabytes / bytes << " GB/sec" << std::endl;
+    std::cout << "ascii by columns: " << gigabytes / columns << " GB/sec, slowdown " << columns / bytes << std::endl;
+    std::cout << "cyrillic by columns: " << cyrillicGigabytes / unicode << " GB/sec" << std::endl;
+}
+
+TEST(WordWrapBenchmark, DISABLED_OptimalFit)
+{
+    const std::string text = MakeText(s_benchmarkBytes / 4);
+    const double megabytes = text.size() / (1024.0 * 1024.0);
+
+    size_t greedyLines = 0;
+    size_t optimalLines = 0;
+    const double greedy = MeasureSeconds([&]() { greedyLines = CountLines(wrap::LineWrapper(text, s_lineLimit)); });
+    const double optimal = MeasureSeconds([&]() { optimalLines = CountLines(wrap::OptimalWrapper(text, s_lineLimit)); });
+    EXPECT_NE(0u, optimalLines);
+    std::cout << "paragraphs of ~50 words, greedy: " << megabytes / greedy << " MB/sec, " << greedyLines << " lines" << std::endl;
+    std::cout << "paragraphs of ~50 words, optimal: " << megabytes / optimal << " MB/sec, " << optimalLines
+              << " lines, slowdown " << optimal / greedy << std::endl;
+
+    // One paragraph, as long as an interactive editor should keep up with
+    const size_t wordCounts[] = { 10000, 100000, 1000000 };
+    for (size_t words : wordCounts)
+    {
+        std::string paragraph = MakeText(words * 7);
+        std::replace(paragraph.begin(), paragraph.end(), '\n', ' ');
+        const double greedySeconds = MeasureBestSeconds([&]() { CountLines(wrap::LineWrapper(paragraph, s_lineLimit)); });
+        const double optimalSeconds = MeasureBestSeconds([&]() { CountLines(wrap::OptimalWrapper(paragraph, s_lineLimit)); });
+        std::cout << "paragraph of ~" << words << " words, greedy: " << greedySeconds * 1000 << " ms, optimal: "
+                  << optimalSeconds * 1000 << " ms" << std::endl;
+    }
+}
+
+TEST(WordWrapBenchmark, DISABLED_DocumentWrapping)
+{
+    const std::string text = MakeText(s_benchmarkBytes);
+    const double megabytes = text.size() / (1024.0 * 1024.0);
+
+    // Kept as views like the document keeps them
+    size_t serialLines = 0;
+    const double serial = MeasureSeconds([&]()
+    {
+        std::vector<std::string_view> lines;
+        wrap::ForEachLine(text, s_lineLimit, [&lines](std::string_view line) { lines.push_back(line); });
+        serialLines = lines.size();
+    });
+    std::cout << "serial: " << megabytes / serial << " MB/sec" << std::endl;
+
+    const unsigned threadsCounts[] = { 1, 2, 4, 8 };
+    for (unsigned threads : threadsCounts)
+    {
+        wrap::DocumentWrapper wrapper(threads);
+        const wrap::WrapMode modes[] = { wrap::WrapMode::Greedy, wrap::WrapMode::Optimal };
+        for (wrap::WrapMode mode : modes)
+        {
+            size_t lines = 0;
+            const double seconds = MeasureSeconds([&]() { lines = wrapper.Wrap(text, s_lineLimit, mode).GetLinesCount(); });
+            if (mode == wrap::WrapMode::Greedy)
+            {
+                EXPECT_EQ(serialLines, lines);
+            }
+            std::cout << threads << " threads, " << (mode == wrap::WrapMode::Greedy ? "greedy" : "optimal") << ": "
+                      << megabytes / seconds << " MB/sec" << std::endl;
+        }
+    }
+}
+
+TEST(WordWrapBenchmark, DISABLED_IncrementalLayout)
+{
+    // A long chat history, a message per paragraph
+    const std::string text = MakeText(4 * 1024 * 1024);
+    const int keystrokes = 1000;
+
+    const double full = MeasureSeconds([&]()
+    {
+        for (int keystroke = 0; keystroke < keystrokes / 100; ++keystroke)
+        {
+            std::vector<std::string_view> lines;
+            wrap::ForEachLine(text, s_lineLimit, [&lines](std::string_view line) { lines.push_back(line); });
+        }
+    }) * 100;
+
+    wrap::TextLayout layout(text, s_lineLimit);
+    size_t wrapped = layout.GetWrappedLinesCount();
+    const double incremental = MeasureSeconds([&]()
+    {
+        for (int keystroke = 0; keystroke < keystrokes; ++keystroke)
+        {
+            layout.Replace(text.size() / 2 + keystroke, 0, keystroke % 6 == 5 ? " " : "x");
+        }
+    });
+    std::cout << "keystroke, full re-wrap: " << full / keystrokes * 1e6 << " us, incremental: "
+              << incremental / keystrokes * 1e6 << " us, lines wrapped per keystroke: "
+              << double(layout.GetWrappedLinesCount() - wrapped) / keystrokes << std::endl;
+
+    const size_t limits[] = { 81, 80, 100, 60, 80 };
+    for (size_t limit : limits)
+    {
+        wrapped = layout.GetWrappedLinesCount();
+        const double resize = MeasureSeconds([&]() { layout.SetLimit(limit); });
+        std::cout << "resize to " << limit << ": " << resize * 1e3 << " ms, re-wrapped "
+                  << 100.0 * (layout.GetWrappedLinesCount() - wrapped) / layout.GetLinesCount() << "% of lines, full re-wrap "
+                  << full / keystrokes * 1e3 << " ms" << std::endl;
+    }
+}
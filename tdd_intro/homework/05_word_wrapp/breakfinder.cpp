@@ -0,0 +1,191 @@
+#include "breakfinder.h"
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WRAP_HAS_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(WRAP_HAS_SSE2) && defined(__GNUC__)
+#define WRAP_HAS_AVX2
+#include <immintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace
+{
+    const size_t s_npos = std::string_view::npos;
+
+    // Index of the lowest and of the highest set bit, mask must not be zero
+    unsigned FirstBit(uint32_t mask)
+    {
+#ifdef _MSC_VER
+        unsigned long index = 0;
+        _BitScanForward(&index, mask);
+        return index;
+#else
+        return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+    }
+
+    unsigned LastBit(uint32_t mask)
+    {
+#ifdef _MSC_VER
+        unsigned long index = 0;
+        _BitScanReverse(&index, mask);
+        return index;
+#else
+        return 31 - static_cast<unsigned>(__builtin_clz(mask));
+#endif
+    }
+
+    Breaks FindBreaksScalar(const char* text, size_t size)
+    {
+        Breaks breaks = { s_npos, s_npos, true };
+        unsigned char bits = 0;
+        for (size_t index = 0; index < size; ++index)
+        {
+            if (text[index] == '\n')
+            {
+                breaks.newline = index;
+                breaks.space = s_npos;
+                break;
+            }
+            if (text[index] == ' ')
+            {
+                breaks.space = index;
+            }
+            bits |= static_cast<unsigned char>(text[index]);
+        }
+        breaks.ascii = bits < 0x80;
+        return breaks;
+    }
+
+    // Takes the masks of the vector at offset, true when the search is over
+    bool TakeMasks(uint32_t newlines, uint32_t spaces, uint32_t highBits, size_t offset, Breaks& breaks)
+    {
+        if (newlines != 0)
+        {
+            const unsigned newline = FirstBit(newlines);
+            breaks.newline = offset + newline;
+            breaks.space = s_npos;
+            breaks.ascii = breaks.ascii && (highBits & ((1u << newline) - 1)) == 0;
+            return true;
+        }
+        if (spaces != 0)
+        {
+            breaks.space = offset + LastBit(spaces);
+        }
+        breaks.ascii = breaks.ascii && highBits == 0;
+        return false;
+    }
+
+#ifdef WRAP_HAS_SSE2
+    const size_t s_sse2Width = 16;
+
+    Breaks FindBreaksSse2(const char* text, size_t size)
+    {
+        if (size < s_sse2Width)
+        {
+            return FindBreaksScalar(text, size);
+        }
+
+        const __m128i newline = _mm_set1_epi8('\n');
+        const __m128i space = _mm_set1_epi8(' ');
+        Breaks breaks = { s_npos, s_npos, true };
+        for (size_t offset = 0;; offset += s_sse2Width)
+        {
+            // Earlier vectors had no newline, so the overlap can't give an earlier one
+            const bool last = offset + s_sse2Width >= size;
+            offset = last ? size - s_sse2Width : offset;
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + offset));
+            const uint32_t newlines = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline)));
+            const uint32_t spaces = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, space)));
+            const uint32_t highBits = static_cast<uint32_t>(_mm_movemask_epi8(chunk));
+            if (TakeMasks(newlines, spaces, highBits, offset, breaks) || last)
+            {
+                return breaks;
+            }
+        }
+    }
+#endif
+
+#ifdef WRAP_HAS_AVX2
+    const size_t s_avx2Width = 32;
+
+    __attribute__((target("avx2")))
+    Breaks FindBreaksAvx2(const char* text, size_t size)
+    {
+        if (size < s_avx2Width)
+        {
+            return FindBreaksSse2(text, size);
+        }
+
+        const __m256i newline = _mm256_set1_epi8('\n');
+        const __m256i space = _mm256_set1_epi8(' ');
+        Breaks breaks = { s_npos, s_npos, true };
+        for (size_t offset = 0;; offset += s_avx2Width)
+        {
+            const bool last = offset + s_avx2Width >= size;
+            offset = last ? size - s_avx2Width : offset;
+            const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + offset));
+            const uint32_t newlines = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, newline)));
+            const uint32_t spaces = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, space)));
+            const uint32_t highBits = static_cast<uint32_t>(_mm256_movemask_epi8(chunk));
+            if (TakeMasks(newlines, spaces, highBits, offset, breaks) || last)
+            {
+                return breaks;
+            }
+        }
+    }
+#endif
+}
+
+bool wrap::IsBreakKernelSupported(BreakKernel kernel)
+{
+    switch (kernel)
+    {
+    case BreakKernel::Scalar:
+        return true;
+#ifdef WRAP_HAS_SSE2
+    case BreakKernel::Sse2:
+        return true;
+#endif
+#ifdef WRAP_HAS_AVX2
+    case BreakKernel::Avx2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+wrap::BreakKernel wrap::GetBestBreakKernel()
+{
+    static const BreakKernel s_best = IsBreakKernelSupported(BreakKernel::Avx2) ? BreakKernel::Avx2 :
+                                      IsBreakKernelSupported(BreakKernel::Sse2) ? BreakKernel::Sse2 :
+                                                                                  BreakKernel::Scalar;
+    return s_best;
+}
+
+Breaks wrap::FindBreaks(BreakKernel kernel, const char* text, size_t size)
+{
+    switch (kernel)
+    {
+#ifdef WRAP_HAS_AVX2
+    case BreakKernel::Avx2:
+        return FindBreaksAvx2(text, size);
+#endif
+#ifdef WRAP_HAS_SSE2
+    case BreakKernel::Sse2:
+        return FindBreaksSse2(text, size);
+#endif
+    default:
+        return FindBreaksScalar(text, size);
+    }
+}
+
@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <string_view>
+
+// Where a line may end inside a window of the text
+struct Breaks
+{
+    // First '\n' of the window or npos
+    size_t newline;
+    // Last ' ' of the window, npos if there is none or a newline was found
+    size_t space;
+    // No byte before the newline, or of the whole window without one, has the high bit set,
+    // so up to the break every byte is a character of one column
+    bool ascii;
+};
+
+namespace wrap
+{
+    /*
+     * Ways to find the breaks:
+     *  Scalar - checks bytes one by one, works everywhere
+     *  Sse2   - compares 16 bytes at a time, movemask gives a bit per matching byte,
+     *           and of the loaded bytes themselves their high bits, which only non-ASCII bytes have
+     *  Avx2   - same, 32 bytes at a time
+     * Windows shorter than a vector go byte by byte, the last vector of a longer one overlaps the previous.
+     */
+    enum class BreakKernel
+    {
+        Scalar,
+        Sse2,
+        Avx2
+    };
+
+    bool IsBreakKernelSupported(BreakKernel kernel);
+    // The fastest kernel the current CPU runs, detected once
+    BreakKernel GetBestBreakKernel();
+
+    Breaks FindBreaks(BreakKernel kernel, const char* text, size_t size);
+}
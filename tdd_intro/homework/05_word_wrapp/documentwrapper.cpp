@@ -0,0 +1,166 @@
+#include "documentwrapper.h"
+#include "wordwrap.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+    template<typename Wrapper>
+    void WrapInto(Wrapper wrapper, std::vector<std::string_view>& lines)
+    {
+        std::string_view line;
+        while (wrapper.Next(line))
+        {
+            lines.push_back(line);
+        }
+    }
+
+    void WrapChunk(std::string_view chunk, size_t limit, wrap::WrapMode mode, std::vector<std::string_view>& lines)
+    {
+        // Lines come out somewhat shorter than the limit, and paragraphs end with shorter ones still
+        lines.reserve(chunk.size() / std::max<size_t>(limit * 3 / 4, 1) + 1);
+        switch (mode)
+        {
+        case wrap::WrapMode::Columns:
+            WrapInto(wrap::ColumnWrapper(chunk, limit), lines);
+            break;
+        case wrap::WrapMode::Optimal:
+            WrapInto(wrap::OptimalWrapper(chunk, limit), lines);
+            break;
+        default:
+            WrapInto(wrap::LineWrapper(chunk, limit), lines);
+            break;
+        }
+    }
+
+    // Chunks of about the size, each ends right after a '\n' or with the text
+    std::vector<std::string_view> SplitParagraphs(std::string_view text, size_t chunkSize)
+    {
+        std::vector<std::string_view> chunks;
+        size_t position = 0;
+        while (position < text.size())
+        {
+            const size_t newline = position + chunkSize >= text.size() ? std::string_view::npos
+                                                                      : text.find('\n', position + chunkSize - 1);
+            const size_t end = newline == std::string_view::npos ? text.size() : newline + 1;
+            chunks.push_back(text.substr(position, end - position));
+            position = end;
+        }
+        return chunks;
+    }
+}
+
+size_t wrap::WrappedDocument::GetLinesCount() const
+{
+    return m_firstLines.empty() ? 0 : m_firstLines.back() + m_chunks.back().size();
+}
+
+std::string_view wrap::WrappedDocument::GetLine(size_t index) const
+{
+    const size_t chunk = std::upper_bound(m_firstLines.begin(), m_firstLines.end(), index) - m_firstLines.begin() - 1;
+    return m_chunks[chunk][index - m_firstLines[chunk]];
+}
+
+wrap::DocumentWrapper::DocumentWrapper(unsigned threadsCount, size_t chunkSize)
+    : m_chunkSize(std::max<size_t>(chunkSize, 1))
+    , m_stopping(false)
+{
+    const unsigned count = threadsCount != 0 ? threadsCount : std::max(std::thread::hardware_concurrency(), 1u);
+    m_workers.reserve(count);
+    for (unsigned i = 0; i < count; ++i)
+    {
+        m_workers.emplace_back(&DocumentWrapper::Work, this);
+    }
+}
+
+wrap::DocumentWrapper::~DocumentWrapper()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_tasksReady.notify_all();
+    for (std::thread& worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+wrap::WrappedDocument wrap::DocumentWrapper::Wrap(std::string_view text, size_t limit, WrapMode mode)
+{
+    // Here, since the wrappers would throw only after room for the lines of their chunk is reserved
+    if (limit == 0)
+    {
+        throw std::runtime_error("line length limit must be positive");
+    }
+    const std::vector<std::string_view> chunks = SplitParagraphs(text, m_chunkSize);
+    WrappedDocument document;
+    document.m_chunks.resize(std::max<size_t>(chunks.size(), 1));
+    if (chunks.size() <= 1)
+    {
+        // Not worth a trip to the workers
+        WrapChunk(text, limit, mode, document.m_chunks.front());
+        document.m_firstLines.push_back(0);
+        return document;
+    }
+
+    std::vector<std::future<void>> pending;
+    pending.reserve(chunks.size());
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (size_t index = 0; index < chunks.size(); ++index)
+        {
+            std::vector<std::string_view>& lines = document.m_chunks[index];
+            std::packaged_task<void()> task([chunk = chunks[index], limit, mode, &lines]()
+            {
+                WrapChunk(chunk, limit, mode, lines);
+            });
+            pending.push_back(task.get_future());
+            m_tasks.push_back(std::move(task));
+        }
+    }
+    m_tasksReady.notify_all();
+
+    // Wait for all chunks before rethrowing, they write into the document
+    for (std::future<void>& done : pending)
+    {
+        done.wait();
+    }
+    for (std::future<void>& done : pending)
+    {
+        done.get();
+    }
+
+    size_t lines = 0;
+    document.m_firstLines.reserve(chunks.size());
+    for (const std::vector<std::string_view>& chunk : document.m_chunks)
+    {
+        document.m_firstLines.push_back(lines);
+        lines += chunk.size();
+    }
+    return document;
+}
+
+unsigned wrap::DocumentWrapper::GetThreadsCount() const
+{
+    return static_cast<unsigned>(m_workers.size());
+}
+
+void wrap::DocumentWrapper::Work()
+{
+    for (;;)
+    {
+        std::packaged_task<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_tasksReady.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+            if (m_tasks.empty())
+            {
+                return;
+            }
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+        task();
+    }
+}
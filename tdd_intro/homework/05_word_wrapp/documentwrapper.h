@@ -0,0 +1,80 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace wrap
+{
+    enum class WrapMode
+    {
+        Greedy,  // LineWrapper
+        Columns, // ColumnWrapper
+        Optimal  // OptimalWrapper
+    };
+
+    /*
+     * Lines of a document, as views into its text. Every chunk of the document keeps the lines
+     * it was wrapped into, the document only knows where each chunk starts, so joining them copies nothing.
+     */
+    class WrappedDocument
+    {
+    public:
+        size_t GetLinesCount() const;
+        std::string_view GetLine(size_t index) const;
+
+        template<typename OnLine>
+        void ForEachLine(OnLine onLine) const
+        {
+            for (const std::vector<std::string_view>& chunk : m_chunks)
+            {
+                for (std::string_view line : chunk)
+                {
+                    onLine(line);
+                }
+            }
+        }
+
+    private:
+        friend class DocumentWrapper;
+
+        std::vector<std::vector<std::string_view>> m_chunks;
+        // Lines before each chunk
+        std::vector<size_t> m_firstLines;
+    };
+
+    /*
+     * Wraps large documents on a pool of threads. Paragraphs are wrapped independently, so the text
+     * is cut into chunks of whole paragraphs, and each chunk is wrapped by a worker into its own lines.
+     * Documents smaller than a chunk are wrapped right in the calling thread.
+     */
+    class DocumentWrapper
+    {
+    public:
+        // Zero threads count means a thread per core
+        explicit DocumentWrapper(unsigned threadsCount, size_t chunkSize = 1024 * 1024);
+        ~DocumentWrapper();
+
+        DocumentWrapper(const DocumentWrapper&) = delete;
+        DocumentWrapper& operator=(const DocumentWrapper&) = delete;
+
+        // The text must outlive the document. Throws std::runtime_error for zero limit.
+        WrappedDocument Wrap(std::string_view text, size_t limit, WrapMode mode = WrapMode::Greedy);
+
+        unsigned GetThreadsCount() const;
+
+    private:
+        void Work();
+
+        size_t m_chunkSize;
+        std::mutex m_mutex;
+        std::condition_variable m_tasksReady;
+        std::deque<std::packaged_task<void()>> m_tasks;
+        bool m_stopping;
+        std::vector<std::thread> m_workers;
+    };
+}
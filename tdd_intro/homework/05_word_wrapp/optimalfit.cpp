@@ -0,0 +1,137 @@
+#include "optimalfit.h"
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+    // Cost of a line wider than the limit, later candidates win ties so it never gets chosen
+    const uint64_t s_tooWide = std::numeric_limits<uint64_t>::max();
+
+    std::string_view TrimTrailingSpaces(std::string_view line)
+    {
+        const size_t last = line.find_last_not_of(' ');
+        return last == std::string_view::npos ? std::string_view() : line.substr(0, last + 1);
+    }
+}
+
+void wrap::ParagraphFitter::Fit(std::string_view paragraph, size_t limit, std::vector<std::string_view>& lines)
+{
+    SplitWords(paragraph, limit);
+    if (m_starts.empty())
+    {
+        // Blank paragraph is one empty line
+        lines.emplace_back();
+        return;
+    }
+    FindBreaks(limit);
+
+    m_breaks.clear();
+    for (size_t word = m_starts.size(); word != 0; word = m_previous[word])
+    {
+        m_breaks.push_back(word);
+    }
+    size_t start = 0;
+    for (auto end = m_breaks.rbegin(); end != m_breaks.rend(); ++end)
+    {
+        lines.push_back(TrimTrailingSpaces(paragraph.substr(m_starts[start], m_ends[*end - 1] - m_starts[start])));
+        start = *end;
+    }
+}
+
+void wrap::ParagraphFitter::SplitWords(std::string_view paragraph, size_t limit)
+{
+    m_starts.clear();
+    m_ends.clear();
+    size_t position = paragraph.find_first_not_of(' ');
+    while (position != std::string_view::npos)
+    {
+        const size_t end = std::min(paragraph.find(' ', position), paragraph.size());
+        // The first word takes the indentation of the paragraph along when both fit, as the greedy wrapping does
+        size_t start = m_starts.empty() && end <= limit ? 0 : position;
+        for (; end - start > limit; start += limit)
+        {
+            m_starts.push_back(start);
+            m_ends.push_back(start + limit);
+        }
+        m_starts.push_back(start);
+        m_ends.push_back(end);
+        position = paragraph.find_first_not_of(' ', end);
+    }
+}
+
+uint64_t wrap::ParagraphFitter::GetCost(size_t candidate, size_t word, size_t limit) const
+{
+    const size_t width = m_ends[word - 1] - m_starts[candidate];
+    if (width > limit)
+    {
+        return s_tooWide;
+    }
+    const uint64_t slack = limit - width;
+    return m_costs[candidate] + slack * slack;
+}
+
+void wrap::ParagraphFitter::FindBreaks(size_t limit)
+{
+    const size_t count = m_starts.size();
+    m_costs.assign(count + 1, 0);
+    m_previous.assign(count + 1, 0);
+    m_queue.clear();
+    size_t head = 0;
+
+    for (size_t word = 1; word <= count; ++word)
+    {
+        // A line may start at the previous word now
+        const size_t candidate = word - 1;
+        while (m_queue.size() > head && GetCost(candidate, std::max(m_queue.back().from, word), limit) <=
+                                        GetCost(m_queue.back().word, std::max(m_queue.back().from, word), limit))
+        {
+            m_queue.pop_back();
+        }
+        if (m_queue.size() == head)
+        {
+            m_queue.push_back({ candidate, word });
+        }
+        else
+        {
+            // First word for which the candidate beats the last one in the queue, if there is such.
+            // Words are a byte and a space at least, so past limit / 2 of them the last one is too wide.
+            const size_t last = m_queue.back().word;
+            size_t low = std::max(m_queue.back().from, word) + 1;
+            size_t high = std::min(count + 1, last + limit / 2 + 2);
+            while (low < high)
+            {
+                const size_t middle = low + (high - low) / 2;
+                if (GetCost(candidate, middle, limit) <= GetCost(last, middle, limit))
+                {
+                    high = middle;
+                }
+                else
+                {
+                    low = middle + 1;
+                }
+            }
+            if (low <= count)
+            {
+                m_queue.push_back({ candidate, low });
+            }
+        }
+
+        while (m_queue.size() > head + 1 && m_queue[head + 1].from <= word)
+        {
+            ++head;
+        }
+        m_costs[word] = GetCost(m_queue[head].word, word, limit);
+        m_previous[word] = m_queue[head].word;
+    }
+
+    // The last line costs nothing, so it starts wherever the lines before it cost least
+    uint64_t best = s_tooWide;
+    for (size_t start = count; start-- != 0 && m_ends[count - 1] - m_starts[start] <= limit;)
+    {
+        if (m_costs[start] < best)
+        {
+            best = m_costs[start];
+            m_previous[count] = start;
+        }
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace wrap
+{
+    /*
+     * Breaks a paragraph into lines so that the sum of squared slack, the bytes a line is short of the limit,
+     * is the least possible. The last line is free, it's as short as the paragraph makes it.
+     *
+     * Lines keep the spaces between their words as they are in the text, a word longer than the limit
+     * is cut at the limit into pieces that lines are made of like words. Indentation which doesn't fit
+     * together with the first word is dropped.
+     *
+     * The textbook dynamic programming tries every earlier break for every word.
+     * The cost of a line is a convex function of its width, so for two candidate breaks
+     * the later one, once better, stays better for all further words. Candidates are kept in a queue
+     * with the word from which each of them is the best, found by binary search. A line holds limit / 2 words
+     * at most, so that takes O(n log limit) for n words.
+     */
+    class ParagraphFitter
+    {
+    public:
+        // Appends lines of the paragraph, which must not have '\n', to lines. Limit must be positive.
+        void Fit(std::string_view paragraph, size_t limit, std::vector<std::string_view>& lines);
+
+    private:
+        struct Candidate
+        {
+            // Where the line starts and the first word it's the best break for
+            size_t word;
+            size_t from;
+        };
+
+        void SplitWords(std::string_view paragraph, size_t limit);
+        void FindBreaks(size_t limit);
+        // Cost of all lines up to the word when the last of them starts at the candidate
+        uint64_t GetCost(size_t candidate, size_t word, size_t limit) const;
+
+        // Words and pieces of long words, as offsets in the paragraph
+        std::vector<size_t> m_starts;
+        std::vector<size_t> m_ends;
+        // For the words before each index: the least cost and where its last line starts
+        std::vector<uint64_t> m_costs;
+        std::vector<size_t> m_previous;
+        std::vector<Candidate> m_queue;
+        std::vector<size_t> m_breaks;
+    };
+}
@@ -16,4 +16,447 @@ ignoring any possible match beginning after pos
 */
 
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <cctype>
+#include <cstdint>
+#include "wordwrap.h"
+#include "unicode.h"
+#include "documentwrapper.h"
+#include "textlayout.h"
+
+namespace
+{
+    // Sum of squared slack of all lines but the last, what the optimal fit minimizes for a paragraph
+    uint64_t GetRaggedness(const std::vector<std::string>& lines, size_t limit)
+    {
+        uint64_t cost = 0;
+        for (size_t line = 0; line + 1 < lines.size(); ++line)
+        {
+            const uint64_t slack = limit - lines[line].size();
+            cost += slack * slack;
+        }
+        return cost;
+    }
+
+    // The textbook quadratic dynamic programming over words separated by single spaces
+    uint64_t GetLeastRaggedness(const std::vector<size_t>& words, size_t limit)
+    {
+        const uint64_t tooWide = UINT64_MAX;
+        std::vector<uint64_t> costs(words.size() + 1, tooWide);
+        costs[0] = 0;
+        uint64_t best = tooWide;
+        for (size_t start = 0; start < words.size(); ++start)
+        {
+            size_t width = words[start];
+            for (size_t end = start + 1; width <= limit; width += 1 + words[end++])
+            {
+                if (end == words.size())
+                {
+                    best = std::min(best, costs[start]);
+                    break;
+                }
+                costs[end] = std::min(costs[end], costs[start] + (limit - width) * (limit - width));
+            }
+        }
+        return best;
+    }
+}
+
+namespace
+{
+    std::vector<std::string> GetLayoutLines(const wrap::TextLayout& layout)
+    {
+        std::vector<std::string> lines;
+        layout.ForEachLine([&lines](std::string_view line) { lines.emplace_back(line); });
+        return lines;
+    }
+}
+
+namespace
+{
+    const std::string s_example = "When pos is specified, the search only includes sequences of characters that begin at or "
+                                  "before position pos, ignoring any possible match beginning after pos.";
+}
+
+TEST(WordWrap, WrapsAtLastSpace)
+{
+    const std::vector<std::string> expected = {
+        "When pos is specified, the",
+        "search only includes sequences",
+        "of characters that begin at or",
+        "before position pos, ignoring",
+        "any possible match beginning",
+        "after pos."
+    };
+    EXPECT_EQ(expected, wrap::WrapText(s_example, 30));
+}
+
+TEST(WordWrap, CutsWordLongerThanLimit)
+{
+    EXPECT_EQ(std::vector<std::string>({ "abcd", "efgh", "ij" }), wrap::WrapText("abcdefghij", 4));
+    EXPECT_EQ(std::vector<std::string>({ "ab", "abcd", "efg", "c" }), wrap::WrapText("ab abcdefg c", 4));
+}
+
+TEST(WordWrap, WordFillsWholeLine)
+{
+    EXPECT_EQ(std::vector<std::string>({ "abcd", "ef" }), wrap::WrapText("abcd ef", 4));
+    EXPECT_EQ(std::vector<std::string>({ "ab", "cd" }), wrap::WrapText("ab   cd  ", 4));
+}
+
+TEST(WordWrap, EmptyAndBlankText)
+{
+    EXPECT_TRUE(wrap::WrapText("", 10).empty());
+    // Blank, but still a line
+    EXPECT_EQ(std::vector<std::string>({ "" }), wrap::WrapText("   ", 2));
+}
+
+TEST(WordWrap, IndentationWithoutRoomMakesNoEmptyLine)
+{
+    EXPECT_EQ(std::vector<std::string>({ "abcd", "efgh" }), wrap::WrapText("   abcdefgh", 4));
+    EXPECT_EQ(std::vector<std::string>({ "ab", "cd" }), wrap::WrapText("      ab cd", 4));
+    EXPECT_EQ(std::vector<std::string>({ "x", "abcd", "e" }), wrap::WrapText("x\n abcde", 4));
+    EXPECT_EQ(std::vector<std::string>({ "  ab", "cd" }), wrap::WrapText("  ab cd", 4));
+    EXPECT_EQ(std::vector<std::string>({ "abcd", "efgh" }), wrap::WrapColumns("   abcdefgh", 4));
+    EXPECT_EQ(std::vector<std::string>({ "\xC3\xA9\xC3\xA9", "\xC3\xA9" }), wrap::WrapColumns("  \xC3\xA9\xC3\xA9\xC3\xA9", 2));
+    EXPECT_EQ(std::vector<std::string>({ "" }), wrap::WrapText(" ", 1));
+}
+
+TEST(WordWrap, NewlinesEndLines)
+{
+    EXPECT_EQ(std::vector<std::string>({ "one", "", "two", "three", "four" }),
+              wrap::WrapText("one\n\ntwo three \nfour\n", 8));
+}
+
+TEST(WordWrap, ZeroLimitThrows)
+{
+    EXPECT_THROW(wrap::WrapText("abc", 0), std::runtime_error);
+}
+
+TEST(WordWrap, StreamedLinesPointIntoText)
+{
+    const std::vector<std::string> copies = wrap::WrapText(s_example, 17);
+    size_t index = 0;
+    wrap::ForEachLine(s_example, 17, [&](std::string_view line)
+    {
+        ASSERT_LT(index, copies.size());
+        EXPECT_EQ(copies[index++], line);
+        EXPECT_GE(line.data(), s_example.data());
+        EXPECT_LE(line.data() + line.size(), s_example.data() + s_example.size());
+        EXPECT_LE(line.size(), 17u);
+    });
+    EXPECT_EQ(copies.size(), index);
+}
+
+TEST(WordWrap, FindBreaks)
+{
+    const std::string text = "one two\nthree four";
+    const Breaks withNewline = wrap::FindBreaks(wrap::BreakKernel::Scalar, text.data(), text.size());
+    EXPECT_EQ(7u, withNewline.newline);
+    EXPECT_EQ(std::string_view::npos, withNewline.space);
+    const Breaks withoutNewline = wrap::FindBreaks(wrap::BreakKernel::Scalar, text.data(), 7);
+    EXPECT_EQ(std::string_view::npos, withoutNewline.newline);
+    EXPECT_EQ(3u, withoutNewline.space);
+}
+
+TEST(WordWrap, BreakKernelsAgree)
+{
+    // Every window size up to a few vectors, breaks at every position
+    std::string text(100, 'x');
+    uint64_t seed = 7;
+    for (char& symbol : text)
+    {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        const unsigned roll = (seed >> 33) % 40;
+        symbol = roll == 0 ? '\n' : roll < 8 ? ' ' : symbol;
+    }
+
+    const wrap::BreakKernel kernels[] = { wrap::BreakKernel::Sse2, wrap::BreakKernel::Avx2 };
+    for (wrap::BreakKernel kernel : kernels)
+    {
+        if (!wrap::IsBreakKernelSupported(kernel))
+        {
+            continue;
+        }
+        for (size_t offset = 0; offset < text.size(); ++offset)
+        {
+            for (size_t size = 0; offset + size <= text.size(); ++size)
+            {
+                const Breaks expected = wrap::FindBreaks(wrap::BreakKernel::Scalar, text.data() + offset, size);
+                const Breaks actual = wrap::FindBreaks(kernel, text.data() + offset, size);
+                ASSERT_EQ(expected.newline, actual.newline) << offset << " " << size;
+                ASSERT_EQ(expected.space, actual.space) << offset << " " << size;
+            }
+        }
+    }
+}
+
+TEST(WordWrap, DecodeCharacter)
+{
+    char32_t character = 0;
+    EXPECT_EQ(1u, wrap::DecodeCharacter("a", character));
+    EXPECT_EQ(U'a', character);
+    EXPECT_EQ(2u, wrap::DecodeCharacter(u8"ї", character));
+    EXPECT_EQ(U'\u0457', character);
+    EXPECT_EQ(3u, wrap::DecodeCharacter(u8"日", character));
+    EXPECT_EQ(U'\u65E5', character);
+    EXPECT_EQ(4u, wrap::DecodeCharacter(u8"\U0001F600", character));
+    EXPECT_EQ(U'\U0001F600', character);
+}
+
+TEST(WordWrap, DecodeMalformedCharacter)
+{
+    const char* const malformed[] = { "\x80", "\xC3", "\xC3(", "\xC0\xAF", "\xED\xA0\x80", "\xF4\x90\x80\x80", "\xFF" };
+    for (const char* text : malformed)
+    {
+        char32_t character = 0;
+        EXPECT_EQ(1u, wrap::DecodeCharacter(text, character)) << text;
+        EXPECT_EQ(wrap::g_replacementCharacter, character);
+    }
+}
+
+TEST(WordWrap, DisplayWidth)
+{
+    EXPECT_EQ(5u, wrap::DisplayWidth("hello"));
+    EXPECT_EQ(6u, wrap::DisplayWidth(u8"Привіт"));
+    EXPECT_EQ(6u, wrap::DisplayWidth(u8"日本語"));
+    // e with a combining acute accent
+    EXPECT_EQ(1u, wrap::DisplayWidth(u8"e\u0301"));
+    // Family of three joined by ZWJ
+    EXPECT_EQ(2u, wrap::DisplayWidth(u8"\U0001F468\u200D\U0001F469\u200D\U0001F467"));
+    // Flag of Ukraine, thumbs up with a skin tone, heart in emoji presentation
+    EXPECT_EQ(2u, wrap::DisplayWidth(u8"\U0001F1FA\U0001F1E6"));
+    EXPECT_EQ(2u, wrap::DisplayWidth(u8"\U0001F44D\U0001F3FD"));
+    EXPECT_EQ(2u, wrap::DisplayWidth(u8"\u2764\uFE0F"));
+}
+
+TEST(WordWrap, WrapColumnsOfWideCharacters)
+{
+    EXPECT_EQ(std::vector<std::string>({ u8"Привіт", u8"світ" }),
+              wrap::WrapColumns(u8"Привіт світ", 6));
+    EXPECT_EQ(std::vector<std::string>({ u8"日本", u8"語の", u8"文" }),
+              wrap::WrapColumns(u8"日本語の文", 5));
+    EXPECT_EQ(std::vector<std::string>({ u8"日", u8"本" }), wrap::WrapColumns(u8"日本", 1));
+}
+
+TEST(WordWrap, WrapColumnsKeepsClusters)
+{
+    EXPECT_EQ(std::vector<std::string>({ u8"e\u0301e\u0301", u8"e\u0301" }),
+              wrap::WrapColumns(u8"e\u0301e\u0301e\u0301", 2));
+    EXPECT_EQ(std::vector<std::string>({ u8"\U0001F1FA\U0001F1E6", u8"\U0001F1FA\U0001F1E6" }),
+              wrap::WrapColumns(u8"\U0001F1FA\U0001F1E6\U0001F1FA\U0001F1E6", 3));
+    EXPECT_EQ(std::vector<std::string>({ u8"\U0001F468\u200D\U0001F469\u200D\U0001F467", "ok" }),
+              wrap::WrapColumns(u8"\U0001F468\u200D\U0001F469\u200D\U0001F467 ok", 2));
+}
+
+TEST(WordWrap, WrapColumnsOfMalformedText)
+{
+    EXPECT_EQ(std::vector<std::string>({ "\xFF\xFE", "ab" }), wrap::WrapColumns("\xFF\xFE ab", 2));
+}
+
+TEST(WordWrap, WrapColumnsOfMixedText)
+{
+    std::string text;
+    for (int repeat = 0; repeat < 20; ++repeat)
+    {
+        text += u8"plain words 日本語 e\u0301te\u0301 \U0001F44D\U0001F3FD and Київ ";
+    }
+    EXPECT_EQ(wrap::WrapText(s_example, 30), wrap::WrapColumns(s_example, 30));
+    for (size_t columns = 1; columns < 40; ++columns)
+    {
+        for (const std::string& line : wrap::WrapColumns(text, columns))
+        {
+            ASSERT_LE(wrap::DisplayWidth(line), std::max<size_t>(columns, 2)) << line;
+            for (size_t index = 0; index < line.size();)
+            {
+                char32_t character = 0;
+                index += wrap::DecodeCharacter(std::string_view(line).substr(index), character);
+                ASSERT_NE(wrap::g_replacementCharacter, character) << line;
+            }
+        }
+    }
+}
+
+TEST(WordWrap, AsciiKernelsAgree)
+{
+    std::string text(100, 'x');
+    const wrap::BreakKernel kernels[] = { wrap::BreakKernel::Scalar, wrap::BreakKernel::Sse2, wrap::BreakKernel::Avx2 };
+    for (wrap::BreakKernel kernel : kernels)
+    {
+        if (!wrap::IsBreakKernelSupported(kernel))
+        {
+            continue;
+        }
+        for (size_t size = 1; size <= text.size(); ++size)
+        {
+            // Bytes after the newline don't matter
+            const size_t newline = size / 2;
+            for (size_t position = 0; position < size; ++position)
+            {
+                text[position] = '\xC3';
+                ASSERT_FALSE(wrap::FindBreaks(kernel, text.data(), size).ascii) << size << " " << position;
+                text[newline] = '\n';
+                ASSERT_EQ(position >= newline, wrap::FindBreaks(kernel, text.data(), size).ascii) << size << " " << position;
+                text[newline] = 'x';
+                text[position] = 'x';
+            }
+            ASSERT_TRUE(wrap::FindBreaks(kernel, text.data(), size).ascii) << size;
+        }
+    }
+}
+
+TEST(WordWrap, OptimalFitEvensLinesOut)
+{
+    // Greedy leaves slack of 0 and 4, optimal fit 3 and 1
+    EXPECT_EQ(std::vector<std::string>({ "aaa bb", "cc", "ddddd" }), wrap::WrapText("aaa bb cc ddddd", 6));
+    EXPECT_EQ(std::vector<std::string>({ "aaa", "bb cc", "ddddd" }), wrap::WrapOptimal("aaa bb cc ddddd", 6));
+
+    const std::vector<std::string> greedy = wrap::WrapText(s_example, 30);
+    const std::vector<std::string> optimal = wrap::WrapOptimal(s_example, 30);
+    EXPECT_LE(GetRaggedness(optimal, 30), GetRaggedness(greedy, 30));
+}
+
+TEST(WordWrap, OptimalFitKeepsRules)
+{
+    EXPECT_EQ(std::vector<std::string>({ "abcd", "efgh", "ij", "kl" }), wrap::WrapOptimal("abcdefghij kl", 4));
+    EXPECT_EQ(std::vector<std::string>({ "a b", "", "c", "   d" }), wrap::WrapOptimal("a b  \n\nc\n   d  ", 5));
+    EXPECT_EQ(std::vector<std::string>({ "  a", "b" }), wrap::WrapOptimal("  a b", 3));
+    EXPECT_EQ(std::vector<std::string>({ "ab", "cd" }), wrap::WrapOptimal("      ab cd", 4));
+    EXPECT_EQ(std::vector<std::string>({ "abcd", "efgh" }), wrap::WrapOptimal("   abcdefgh", 4));
+    EXPECT_EQ(std::vector<std::string>({ "x", "abcd", "e" }), wrap::WrapOptimal("x\n abcde", 4));
+    EXPECT_EQ(std::vector<std::string>({ "" }), wrap::WrapOptimal("   ", 3));
+    EXPECT_TRUE(wrap::WrapOptimal("", 3).empty());
+    EXPECT_THROW(wrap::OptimalWrapper("abc", 0), std::runtime_error);
+}
+
+TEST(WordWrap, OptimalFitMatchesQuadraticFit)
+{
+    uint64_t seed = 7;
+    for (size_t limit = 8; limit <= 40; ++limit)
+    {
+        std::vector<size_t> words;
+        std::string paragraph;
+        for (int word = 0; word < 300; ++word)
+        {
+            seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+            words.push_back(1 + (seed >> 33) % 8);
+            paragraph += (paragraph.empty() ? "" : " ") + std::string(words.back(), 'a' + (seed >> 40) % 26);
+        }
+
+        const std::vector<std::string> lines = wrap::WrapOptimal(paragraph, limit);
+        std::string joined;
+        for (const std::string& line : lines)
+        {
+            ASSERT_LE(line.size(), limit);
+            joined += (joined.empty() ? "" : " ") + line;
+        }
+        ASSERT_EQ(paragraph, joined);
+        ASSERT_EQ(GetLeastRaggedness(words, limit), GetRaggedness(lines, limit)) << limit;
+    }
+}
+
+TEST(WordWrap, DocumentWrapperMatchesSerialWrapping)
+{
+    std::string text;
+    for (int paragraph = 0; paragraph < 40; ++paragraph)
+    {
+        text += s_example.substr(0, paragraph * 7 % s_example.size()) + (paragraph % 5 == 0 ? "\n\n" : "\n");
+    }
+
+    wrap::DocumentWrapper wrapper(3, 100);
+    const std::pair<wrap::WrapMode, std::vector<std::string>> modes[] = {
+        { wrap::WrapMode::Greedy, wrap::WrapText(text, 30) },
+        { wrap::WrapMode::Columns, wrap::WrapColumns(text, 30) },
+        { wrap::WrapMode::Optimal, wrap::WrapOptimal(text, 30) }
+    };
+    for (const auto& mode : modes)
+    {
+        const wrap::WrappedDocument document = wrapper.Wrap(text, 30, mode.first);
+        std::vector<std::string> lines;
+        document.ForEachLine([&lines](std::string_view line) { lines.emplace_back(line); });
+        EXPECT_EQ(mode.second, lines);
+        ASSERT_EQ(mode.second.size(), document.GetLinesCount());
+        for (size_t index = 0; index < lines.size(); ++index)
+        {
+            ASSERT_EQ(lines[index], document.GetLine(index));
+            ASSERT_TRUE(lines[index].empty() || (document.GetLine(index).data() >= text.data() &&
+                                                 document.GetLine(index).data() < text.data() + text.size()));
+        }
+    }
+}
+
+TEST(WordWrap, DocumentWrapperOfSmallDocuments)
+{
+    wrap::DocumentWrapper wrapper(2, 100);
+    EXPECT_EQ(0u, wrapper.Wrap("", 10).GetLinesCount());
+    EXPECT_EQ("aaa", wrapper.Wrap("aaa bb", 4).GetLine(0));
+    EXPECT_THROW(wrapper.Wrap("aaa bb", 0), std::runtime_error);
+    EXPECT_THROW(wrapper.Wrap(std::string(1000, 'a'), 0), std::runtime_error);
+    EXPECT_THROW(wrapper.Wrap("", 0), std::runtime_error);
+    EXPECT_EQ(2u, wrapper.GetThreadsCount());
+}
+
+TEST(WordWrap, TextLayoutFollowsEdits)
+{
+    wrap::TextLayout layout("", 12);
+    EXPECT_EQ(0u, layout.GetLinesCount());
+
+    uint64_t seed = 3;
+    const std::string pieces[] = { "word", " ", "  ", "\n", "a longer sentence", "x", "\n\n", "verylongwordthatiscut " };
+    for (int edit = 0; edit < 2000; ++edit)
+    {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        const std::string& text = layout.GetText();
+        const size_t position = text.empty() ? 0 : (seed >> 33) % (text.size() + 1);
+        const size_t length = text.size() > 300 || (seed >> 20) % 3 == 0 ? std::min<size_t>((seed >> 40) % 8, text.size() - position) : 0;
+        layout.Replace(position, length, pieces[(seed >> 50) % 8]);
+        if (edit % 50 == 0)
+        {
+            layout.SetLimit(5 + (seed >> 25) % 15);
+        }
+
+        const std::vector<std::string> expected = wrap::WrapText(layout.GetText(), layout.GetLimit());
+        ASSERT_EQ(expected, GetLayoutLines(layout)) << edit;
+        ASSERT_EQ(expected.size(), layout.GetLinesCount());
+    }
+    EXPECT_THROW(layout.Replace(layout.GetText().size() + 1, 0, "a"), std::runtime_error);
+    EXPECT_THROW(layout.Replace(0, layout.GetText().size() + 1, "a"), std::runtime_error);
+}
+
+TEST(WordWrap, TextLayoutRewrapsOnlyAroundEdit)
+{
+    std::string text;
+    for (int paragraph = 0; paragraph < 20; ++paragraph)
+    {
+        text += s_example + " " + s_example + "\n";
+    }
+    wrap::TextLayout layout(text, 30);
+    const size_t wrapped = layout.GetWrappedLinesCount();
+
+    // A letter in the middle of a paragraph moves a word or two, the lines after it come back in line soon
+    layout.Replace(text.size() / 2, 0, "x");
+    EXPECT_LE(layout.GetWrappedLinesCount() - wrapped, 4u);
+    text.insert(text.size() / 2, "x");
+    EXPECT_EQ(wrap::WrapText(text, 30), GetLayoutLines(layout));
+
+    // A new message in a chat only wraps itself
+    const size_t edited = layout.GetWrappedLinesCount();
+    layout.Append("one more message\n");
+    EXPECT_EQ(edited + 2, layout.GetWrappedLinesCount());
+}
+
+TEST(WordWrap, TextLayoutReusesParagraphsOnResize)
+{
+    const std::string text = "short message\n" + s_example + "\n\nok\n" + std::string(50, 'z');
+    wrap::TextLayout layout(text, 30);
+    const std::vector<size_t> limits = { 31, 40, 35, 14, 13, 80, 1, 30 };
+    for (size_t limit : limits)
+    {
+        const size_t wrapped = layout.GetWrappedLinesCount();
+        layout.SetLimit(limit);
+        const std::vector<std::string> expected = wrap::WrapText(text, limit);
+        ASSERT_EQ(expected, GetLayoutLines(layout)) << limit;
+        // The long word is cut elsewhere with every limit, the short messages are not touched
+        EXPECT_LT(layout.GetWrappedLinesCount() - wrapped, expected.size()) << limit;
+    }
+    EXPECT_THROW(layout.SetLimit(0), std::runtime_error);
+}
@@ -0,0 +1,234 @@
+#include "textlayout.h"
+#include "wordwrap.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+    void CheckLimit(size_t limit)
+    {
+        if (limit == 0)
+        {
+            throw std::runtime_error("line length limit must be positive");
+        }
+    }
+
+    size_t Shift(size_t offset, ptrdiff_t shift)
+    {
+        return static_cast<size_t>(static_cast<ptrdiff_t>(offset) + shift);
+    }
+}
+
+wrap::TextLayout::TextLayout(std::string_view text, size_t limit)
+    : m_limit(limit)
+    , m_paragraphs(1, Paragraph{ 0, { Line{ 0, 0 } }, false, 0, 0 })
+    , m_linesCount(1)
+    , m_wrappedLinesCount(0)
+{
+    CheckLimit(limit);
+    Replace(0, 0, text);
+}
+
+void wrap::TextLayout::Replace(size_t position, size_t length, std::string_view text)
+{
+    if (position > m_text.size() || length > m_text.size() - position)
+    {
+        throw std::runtime_error("edit is out of the text");
+    }
+
+    // Paragraphs the edit touches, the '\n' after a paragraph belongs to it
+    size_t first = 0;
+    size_t firstStart = 0;
+    while (firstStart + m_paragraphs[first].size < position)
+    {
+        firstStart += m_paragraphs[first++].size + 1;
+    }
+    size_t last = first;
+    size_t lastStart = firstStart;
+    while (lastStart + m_paragraphs[last].size < position + length)
+    {
+        lastStart += m_paragraphs[last++].size + 1;
+    }
+    const size_t oldEnd = lastStart + m_paragraphs[last].size;
+    for (size_t index = first; index <= last; ++index)
+    {
+        m_linesCount -= m_paragraphs[index].lines.size();
+    }
+    const std::vector<Line> firstLines = std::move(m_paragraphs[first].lines);
+    const std::vector<Line> lastLines = first == last ? std::vector<Line>() : std::move(m_paragraphs[last].lines);
+    const std::vector<Line>& syncLines = first == last ? firstLines : lastLines;
+
+    m_text.replace(position, length, text);
+    const ptrdiff_t delta = static_cast<ptrdiff_t>(text.size()) - static_cast<ptrdiff_t>(length);
+    const size_t end = Shift(oldEnd, delta);
+
+    std::vector<Paragraph> paragraphs;
+    for (size_t start = firstStart;;)
+    {
+        const size_t newline = std::min(m_text.find('\n', start), end);
+        Paragraph paragraph = { newline - start, {}, false, 0, 0 };
+
+        // Lines before the first one that could see the edit are kept, the one before it
+        // too as long as its window doesn't reach the edit, but where its break skips spaces might
+        size_t from = 0;
+        if (paragraphs.empty())
+        {
+            const size_t offset = position - firstStart;
+            const auto seeing = std::find_if(firstLines.begin(), firstLines.end(),
+                                             [this, offset](const Line& line) { return line.start + m_limit >= offset; });
+            const auto kept = seeing == firstLines.begin() ? seeing : std::prev(seeing);
+            paragraph.lines.assign(firstLines.begin(), kept);
+            // The first line may start after indentation it dropped
+            from = kept == firstLines.end() || kept == firstLines.begin() ? 0 : kept->start;
+        }
+
+        if (newline == end)
+        {
+            // The old lines after the edit are good once the wrapping reaches one of them
+            const ptrdiff_t shift = static_cast<ptrdiff_t>(lastStart) + delta - static_cast<ptrdiff_t>(start);
+            WrapParagraph(paragraph, start, from, syncLines, position + length - lastStart, shift);
+            paragraphs.push_back(std::move(paragraph));
+            break;
+        }
+        WrapParagraph(paragraph, start, from, std::vector<Line>(), 0, 0);
+        paragraphs.push_back(std::move(paragraph));
+        start = newline + 1;
+    }
+
+    for (const Paragraph& paragraph : paragraphs)
+    {
+        m_linesCount += paragraph.lines.size();
+    }
+    // Typing within a paragraph keeps the count, moving all paragraphs after it is most of the time an edit takes
+    if (paragraphs.size() == last - first + 1)
+    {
+        std::move(paragraphs.begin(), paragraphs.end(), m_paragraphs.begin() + first);
+        return;
+    }
+    m_paragraphs.erase(m_paragraphs.begin() + first, m_paragraphs.begin() + last + 1);
+    m_paragraphs.insert(m_paragraphs.begin() + first, std::make_move_iterator(paragraphs.begin()),
+                        std::make_move_iterator(paragraphs.end()));
+}
+
+void wrap::TextLayout::Append(std::string_view text)
+{
+    Replace(m_text.size(), 0, text);
+}
+
+void wrap::TextLayout::SetLimit(size_t limit)
+{
+    CheckLimit(limit);
+    m_limit = limit;
+    size_t start = 0;
+    for (Paragraph& paragraph : m_paragraphs)
+    {
+        if (!paragraph.classKnown)
+        {
+            FindWidthClass(paragraph, start);
+        }
+        if (limit < paragraph.minLimit || limit > paragraph.maxLimit)
+        {
+            m_linesCount -= paragraph.lines.size();
+            paragraph.lines.clear();
+            WrapParagraph(paragraph, start, 0, std::vector<Line>(), 0, 0);
+            m_linesCount += paragraph.lines.size();
+        }
+        start += paragraph.size + 1;
+    }
+}
+
+const std::string& wrap::TextLayout::GetText() const
+{
+    return m_text;
+}
+
+size_t wrap::TextLayout::GetLimit() const
+{
+    return m_limit;
+}
+
+size_t wrap::TextLayout::GetLinesCount() const
+{
+    return m_linesCount - m_paragraphs.size() + GetShownParagraphsCount();
+}
+
+size_t wrap::TextLayout::GetWrappedLinesCount() const
+{
+    return m_wrappedLinesCount;
+}
+
+void wrap::TextLayout::WrapParagraph(Paragraph& paragraph, size_t start, size_t from,
+                                     const std::vector<Line>& oldLines, size_t syncFrom, ptrdiff_t shift)
+{
+    paragraph.classKnown = false;
+    if (paragraph.size == 0)
+    {
+        paragraph.lines.push_back({ 0, 0 });
+        ++m_wrappedLinesCount;
+        return;
+    }
+
+    const std::string_view text = std::string_view(m_text).substr(start, paragraph.size);
+    LineWrapper wrapper(text.substr(from), m_limit);
+    auto old = std::find_if(oldLines.begin(), oldLines.end(), [syncFrom](const Line& line) { return line.start >= syncFrom; });
+    for (;;)
+    {
+        const size_t lineStart = from + wrapper.GetPosition();
+        while (old != oldLines.end() && Shift(old->start, shift) < lineStart)
+        {
+            ++old;
+        }
+        // An empty paragraph has a line at its end, no line starts there otherwise
+        if (old != oldLines.end() && Shift(old->start, shift) == lineStart && lineStart < paragraph.size)
+        {
+            for (; old != oldLines.end(); ++old)
+            {
+                paragraph.lines.push_back({ Shift(old->start, shift), old->length });
+            }
+            return;
+        }
+
+        std::string_view line;
+        if (!wrapper.Next(line))
+        {
+            return;
+        }
+        paragraph.lines.push_back({ lineStart, line.size() });
+        ++m_wrappedLinesCount;
+    }
+}
+
+void wrap::TextLayout::FindWidthClass(Paragraph& paragraph, size_t start) const
+{
+    const std::string_view text = std::string_view(m_text).substr(start, paragraph.size);
+    paragraph.minLimit = 0;
+    paragraph.maxLimit = std::numeric_limits<size_t>::max();
+    // Indentation was dropped since it didn't fit together with the first word
+    if (!paragraph.lines.empty() && paragraph.lines.front().start > 0)
+    {
+        const size_t wordEnd = std::min(text.find(' ', paragraph.lines.front().start), text.size());
+        paragraph.maxLimit = wordEnd - 1;
+    }
+    for (size_t index = 0; index < paragraph.lines.size(); ++index)
+    {
+        const Line& line = paragraph.lines[index];
+        // Every line has to fit
+        paragraph.minLimit = std::max(paragraph.minLimit, line.length);
+        if (index + 1 == paragraph.lines.size())
+        {
+            break;
+        }
+        // A cut word is cut elsewhere with any other limit, the first word of a next line must not fit
+        const size_t next = paragraph.lines[index + 1].start;
+        const size_t wordEnd = std::min(text.find(' ', next), text.size());
+        const size_t most = next == line.start + line.length ? line.length : wordEnd - line.start - 1;
+        paragraph.maxLimit = std::min(paragraph.maxLimit, most);
+    }
+    paragraph.classKnown = true;
+}
+
+size_t wrap::TextLayout::GetShownParagraphsCount() const
+{
+    return m_paragraphs.back().size == 0 ? m_paragraphs.size() - 1 : m_paragraphs.size();
+}
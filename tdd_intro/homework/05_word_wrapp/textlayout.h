@@ -0,0 +1,88 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace wrap
+{
+    /*
+     * Text wrapped the greedy way of LineWrapper, kept up to date while the text is edited
+     * and the limit changes, as a text view of a GUI needs it.
+     *
+     * Line breaks are kept per paragraph. A greedy line depends only on the text from its start on,
+     * so an edit re-wraps from the first line that could see it, and stops as soon as a line starts
+     * where an old one did after the edit: from there on the old lines are the same, only shifted.
+     *
+     * A paragraph keeps the same lines for a whole range of limits, from its longest line
+     * up to where the first word of some next line would fit. That is its width class, so a resize
+     * re-wraps only the paragraphs whose class doesn't have the new limit.
+     */
+    class TextLayout
+    {
+    public:
+        // Throws std::runtime_error for zero limit
+        TextLayout(std::string_view text, size_t limit);
+
+        // Replaces length bytes at the position with the text. Throws std::runtime_error when out of the text.
+        void Replace(size_t position, size_t length, std::string_view text);
+        void Append(std::string_view text);
+        // Throws std::runtime_error for zero limit
+        void SetLimit(size_t limit);
+
+        const std::string& GetText() const;
+        size_t GetLimit() const;
+        size_t GetLinesCount() const;
+        // Lines wrapped since the layout was made, the work the edits and resizes took
+        size_t GetWrappedLinesCount() const;
+
+        // Lines are views into the text, valid until the next change
+        template<typename OnLine>
+        void ForEachLine(OnLine onLine) const
+        {
+            size_t start = 0;
+            for (size_t index = 0; index < GetShownParagraphsCount(); ++index)
+            {
+                for (const Line& line : m_paragraphs[index].lines)
+                {
+                    onLine(std::string_view(m_text).substr(start + line.start, line.length));
+                }
+                start += m_paragraphs[index].size + 1;
+            }
+        }
+
+    private:
+        // Offsets in the paragraph
+        struct Line
+        {
+            size_t start;
+            size_t length;
+        };
+
+        struct Paragraph
+        {
+            // Without the '\n'
+            size_t size;
+            // An empty paragraph is an empty line
+            std::vector<Line> lines;
+            // Width class, known once a resize needed it
+            bool classKnown;
+            size_t minLimit;
+            size_t maxLimit;
+        };
+
+        // Lines of the paragraph at start from the line starting at from. Once a line starts at
+        // oldStart + shift for some old line at or after syncFrom, the rest are these old lines shifted.
+        void WrapParagraph(Paragraph& paragraph, size_t start, size_t from,
+                           const std::vector<Line>& oldLines, size_t syncFrom, ptrdiff_t shift);
+        void FindWidthClass(Paragraph& paragraph, size_t start) const;
+        // Text after the last '\n' makes no line when it's empty, same as with LineWrapper
+        size_t GetShownParagraphsCount() const;
+
+        std::string m_text;
+        size_t m_limit;
+        std::vector<Paragraph> m_paragraphs;
+        size_t m_linesCount;
+        size_t m_wrappedLinesCount;
+    };
+}
@@ -0,0 +1,220 @@
+#include "unicode.h"
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+
+namespace
+{
+    struct Range
+    {
+        char32_t first;
+        char32_t last;
+    };
+
+    // Combining marks, zero width spaces and joiners, variation selectors and emoji modifiers
+    const Range s_zeroWidth[] = {
+        { 0x0300, 0x036F }, { 0x0483, 0x0489 }, { 0x0591, 0x05BD }, { 0x05BF, 0x05BF }, { 0x05C1, 0x05C2 },
+        { 0x05C4, 0x05C5 }, { 0x05C7, 0x05C7 }, { 0x0610, 0x061A }, { 0x064B, 0x065F }, { 0x0670, 0x0670 },
+        { 0x06D6, 0x06DC }, { 0x06DF, 0x06E4 }, { 0x06E7, 0x06E8 }, { 0x06EA, 0x06ED }, { 0x0900, 0x0902 },
+        { 0x093A, 0x093A }, { 0x093C, 0x093C }, { 0x0941, 0x0948 }, { 0x094D, 0x094D }, { 0x0951, 0x0957 },
+        { 0x0E31, 0x0E31 }, { 0x0E34, 0x0E3A }, { 0x0E47, 0x0E4E }, { 0x1AB0, 0x1AFF }, { 0x1DC0, 0x1DFF },
+        { 0x200B, 0x200F }, { 0x20D0, 0x20FF }, { 0xFE00, 0xFE0F }, { 0xFE20, 0xFE2F }, { 0x1F3FB, 0x1F3FF },
+        { 0xE0020, 0xE007F }, { 0xE0100, 0xE01EF }
+    };
+
+    // East Asian wide and fullwidth, emoji shown in two columns
+    const Range s_doubleWidth[] = {
+        { 0x1100, 0x115F }, { 0x231A, 0x231B }, { 0x23E9, 0x23EC }, { 0x23F0, 0x23F0 }, { 0x23F3, 0x23F3 },
+        { 0x25FD, 0x25FE }, { 0x2614, 0x2615 }, { 0x2648, 0x2653 }, { 0x267F, 0x267F }, { 0x2693, 0x2693 },
+        { 0x26A1, 0x26A1 }, { 0x26AA, 0x26AB }, { 0x26BD, 0x26BE }, { 0x26C4, 0x26C5 }, { 0x26CE, 0x26CE },
+        { 0x26D4, 0x26D4 }, { 0x26EA, 0x26EA }, { 0x26F2, 0x26F3 }, { 0x26F5, 0x26F5 }, { 0x26FA, 0x26FA },
+        { 0x26FD, 0x26FD }, { 0x2705, 0x2705 }, { 0x270A, 0x270B }, { 0x2728, 0x2728 }, { 0x274C, 0x274C },
+        { 0x274E, 0x274E }, { 0x2753, 0x2755 }, { 0x2757, 0x2757 }, { 0x2795, 0x2797 }, { 0x27B0, 0x27B0 },
+        { 0x27BF, 0x27BF }, { 0x2B1B, 0x2B1C }, { 0x2B50, 0x2B50 }, { 0x2B55, 0x2B55 }, { 0x2E80, 0x303E },
+        { 0x3041, 0x33FF }, { 0x3400, 0x4DBF }, { 0x4E00, 0x9FFF }, { 0xA000, 0xA4CF }, { 0xA960, 0xA97F },
+        { 0xAC00, 0xD7A3 }, { 0xF900, 0xFAFF }, { 0xFE10, 0xFE19 }, { 0xFE30, 0xFE6F }, { 0xFF00, 0xFF60 },
+        { 0xFFE0, 0xFFE6 }, { 0x16FE0, 0x16FE4 }, { 0x17000, 0x18AFF }, { 0x1B000, 0x1B2FF }, { 0x1F004, 0x1F004 },
+        { 0x1F0CF, 0x1F0CF }, { 0x1F18E, 0x1F18E }, { 0x1F191, 0x1F19A }, { 0x1F200, 0x1F251 }, { 0x1F300, 0x1F64F },
+        { 0x1F680, 0x1F6FF }, { 0x1F7E0, 0x1F7EB }, { 0x1F90C, 0x1F9FF }, { 0x1FA70, 0x1FAFF }, { 0x20000, 0x2FFFD },
+        { 0x30000, 0x3FFFD }
+    };
+
+    const char32_t s_zeroWidthJoiner = 0x200D;
+    const char32_t s_emojiPresentation = 0xFE0F;
+    const char32_t s_firstRegionalIndicator = 0x1F1E6;
+    const char32_t s_lastRegionalIndicator = 0x1F1FF;
+
+    template<size_t count>
+    bool InRanges(const Range (&ranges)[count], char32_t character)
+    {
+        const Range* found = std::upper_bound(std::begin(ranges), std::end(ranges), character,
+                                              [](char32_t value, const Range& range) { return value < range.first; });
+        return found != std::begin(ranges) && character <= std::prev(found)->last;
+    }
+
+    unsigned LookUpWidth(char32_t character)
+    {
+        if (InRanges(s_zeroWidth, character))
+        {
+            return 0;
+        }
+        return InRanges(s_doubleWidth, character) ? 2 : 1;
+    }
+
+    // Searching the ranges for every character is the most of the time wrapping takes,
+    // so widths of the Basic Multilingual Plane, where almost all text is, are looked up once
+    const char32_t s_basicPlaneSize = 0x10000;
+
+    struct BasicPlaneWidths
+    {
+        BasicPlaneWidths()
+        {
+            for (char32_t character = 0; character < s_basicPlaneSize; ++character)
+            {
+                widths[character] = static_cast<uint8_t>(LookUpWidth(character));
+            }
+        }
+
+        uint8_t widths[s_basicPlaneSize];
+    };
+
+    bool IsRegionalIndicator(char32_t character)
+    {
+        return character >= s_firstRegionalIndicator && character <= s_lastRegionalIndicator;
+    }
+
+    bool IsContinuation(unsigned char byte)
+    {
+        return (byte & 0xC0) == 0x80;
+    }
+}
+
+size_t wrap::DecodeCharacter(std::string_view text, char32_t& character)
+{
+    const unsigned char lead = static_cast<unsigned char>(text[0]);
+    if (lead < 0x80)
+    {
+        character = lead;
+        return 1;
+    }
+
+    size_t length = 0;
+    char32_t minimum = 0;
+    if ((lead & 0xE0) == 0xC0)
+    {
+        length = 2;
+        minimum = 0x80;
+        character = lead & 0x1F;
+    }
+    else if ((lead & 0xF0) == 0xE0)
+    {
+        length = 3;
+        minimum = 0x800;
+        character = lead & 0x0F;
+    }
+    else if ((lead & 0xF8) == 0xF0)
+    {
+        length = 4;
+        minimum = 0x10000;
+        character = lead & 0x07;
+    }
+    if (length == 0 || text.size() < length)
+    {
+        character = g_replacementCharacter;
+        return 1;
+    }
+
+    for (size_t index = 1; index < length; ++index)
+    {
+        const unsigned char byte = static_cast<unsigned char>(text[index]);
+        if (!IsContinuation(byte))
+        {
+            character = g_replacementCharacter;
+            return 1;
+        }
+        character = character << 6 | (byte & 0x3F);
+    }
+    // Overlong forms, surrogates and values past Unicode are malformed as well
+    if (character < minimum || character > 0x10FFFF || (character >= 0xD800 && character <= 0xDFFF))
+    {
+        character = g_replacementCharacter;
+        return 1;
+    }
+    return length;
+}
+
+unsigned wrap::CharacterWidth(char32_t character)
+{
+    if (character < 0x80)
+    {
+        return 1;
+    }
+    if (character < s_basicPlaneSize)
+    {
+        static const BasicPlaneWidths s_widths;
+        return s_widths.widths[character];
+    }
+    return LookUpWidth(character);
+}
+
+size_t wrap::NextCluster(std::string_view text, unsigned& width)
+{
+    char32_t character = 0;
+    size_t length = DecodeCharacter(text, character);
+    width = CharacterWidth(character);
+    if (character == '\n')
+    {
+        return length;
+    }
+
+    bool joined = false;
+    bool flag = IsRegionalIndicator(character);
+    while (length < text.size())
+    {
+        // Nothing extends a cluster with ASCII, spaces after words are the common case
+        if (!joined && static_cast<unsigned char>(text[length]) < 0x80)
+        {
+            break;
+        }
+        char32_t next = 0;
+        const size_t nextLength = DecodeCharacter(text.substr(length), next);
+        if (next == '\n')
+        {
+            break;
+        }
+        if (flag && IsRegionalIndicator(next))
+        {
+            // Two indicators are one flag
+            flag = false;
+            width = 2;
+        }
+        else if (next == s_emojiPresentation)
+        {
+            width = std::max(width, 2u);
+        }
+        else if (!joined && CharacterWidth(next) == 0)
+        {
+            flag = false;
+        }
+        else if (!joined)
+        {
+            break;
+        }
+        // A character after ZWJ belongs to the cluster, its width is already counted
+        joined = next == s_zeroWidthJoiner;
+        length += nextLength;
+    }
+    return length;
+}
+
+size_t wrap::DisplayWidth(std::string_view text)
+{
+    size_t columns = 0;
+    while (!text.empty())
+    {
+        unsigned width = 0;
+        text.remove_prefix(NextCluster(text, width));
+        columns += width;
+    }
+    return columns;
+}
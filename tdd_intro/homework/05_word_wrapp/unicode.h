@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+#include <string_view>
+
+/*
+ * Just enough of Unicode to wrap text for a terminal:
+ *  - UTF-8 is decoded strictly, every byte of a malformed sequence is a character of its own,
+ *    shown as one column like U+FFFD
+ *  - widths follow wcwidth: East Asian wide and emoji take two columns, combining marks none.
+ *    ASCII takes a column per byte, controls included, same as when wrapping bytes
+ *  - grapheme clusters are a simplified UAX #29: a character with the combining marks,
+ *    variation selectors and emoji modifiers after it, characters joined by ZWJ and
+ *    pairs of regional indicators (flags)
+ */
+namespace wrap
+{
+    const char32_t g_replacementCharacter = 0xFFFD;
+
+    // Decodes the character at the start of text, which must not be empty. Returns its length in bytes.
+    size_t DecodeCharacter(std::string_view text, char32_t& character);
+    unsigned CharacterWidth(char32_t character);
+
+    // Length in bytes of the grapheme cluster at the start of text, which must not be empty
+    size_t NextCluster(std::string_view text, unsigned& width);
+    // Columns the text takes on a terminal
+    size_t DisplayWidth(std::string_view text);
+}
@@ -0,0 +1,238 @@
+#include "wordwrap.h"
+#include "unicode.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+    const size_t s_npos = std::string_view::npos;
+
+    void CheckLimit(size_t limit)
+    {
+        if (limit == 0)
+        {
+            throw std::runtime_error("line length limit must be positive");
+        }
+    }
+
+    std::string_view TrimTrailingSpaces(std::string_view line)
+    {
+        const size_t last = line.find_last_not_of(' ');
+        return last == s_npos ? std::string_view() : line.substr(0, last + 1);
+    }
+
+    // Position of the next line after breaking at the space
+    size_t SkipBreak(std::string_view text, size_t space)
+    {
+        const size_t position = text.find_first_not_of(' ', space);
+        if (position == s_npos)
+        {
+            return text.size();
+        }
+        // The paragraph ends right at the break, so its '\n' is not another line
+        return text[position] == '\n' ? position + 1 : position;
+    }
+
+    size_t ByteWidth(std::string_view text)
+    {
+        return text.size();
+    }
+
+    // Spaces start a line only at the start of a paragraph. When the indentation doesn't fit together with
+    // the first word, the line would break right after the indentation and be empty, so it starts at the word.
+    // A blank paragraph is still an empty line.
+    size_t SkipIndentation(std::string_view text, size_t limit, size_t position, size_t (*width)(std::string_view))
+    {
+        if (position >= text.size() || text[position] != ' ')
+        {
+            return position;
+        }
+        const size_t word = text.find_first_not_of(' ', position);
+        if (word == s_npos || text[word] == '\n')
+        {
+            return position;
+        }
+        const size_t wordEnd = std::min(text.find_first_of(" \n", word), text.size());
+        return word - position + width(text.substr(word, wordEnd - word)) > limit ? word : position;
+    }
+
+    // One character past the limit: a space there still lets the whole limit fit
+    std::string_view GetWindow(std::string_view text, size_t limit, size_t position)
+    {
+        return text.substr(position, limit + 1);
+    }
+
+    // Line of limit bytes at most from position, which must be inside the text, with the breaks of its window
+    std::string_view NextByteLine(std::string_view text, size_t limit, const Breaks& breaks, size_t& position)
+    {
+        const std::string_view window = GetWindow(text, limit, position);
+        if (breaks.newline != s_npos)
+        {
+            position += breaks.newline + 1;
+            return TrimTrailingSpaces(window.substr(0, breaks.newline));
+        }
+        if (window.size() <= limit)
+        {
+            position = text.size();
+            return TrimTrailingSpaces(window);
+        }
+        if (breaks.space == s_npos || breaks.space == 0)
+        {
+            position += limit;
+            return window.substr(0, limit);
+        }
+        position = SkipBreak(text, position + breaks.space);
+        return TrimTrailingSpaces(window.substr(0, breaks.space));
+    }
+
+    // Same, but columns of grapheme clusters are counted
+    std::string_view NextColumnLine(std::string_view text, size_t columns, size_t& position)
+    {
+        const size_t start = position;
+        size_t used = 0;
+        size_t space = s_npos;
+        for (size_t index = start; index < text.size();)
+        {
+            unsigned width = 0;
+            const size_t length = wrap::NextCluster(text.substr(index), width);
+            if (text[index] == '\n')
+            {
+                position = index + 1;
+                return TrimTrailingSpaces(text.substr(start, index - start));
+            }
+            if (text[index] == ' ' && length == 1)
+            {
+                space = used <= columns ? index : space;
+                ++used;
+                ++index;
+                continue;
+            }
+            if (used + width > columns)
+            {
+                if (space != s_npos && space != start)
+                {
+                    position = SkipBreak(text, space);
+                    return TrimTrailingSpaces(text.substr(start, space - start));
+                }
+                // Cut before the cluster, unless it is the first one and nothing fits
+                position = index == start ? index + length : index;
+                return text.substr(start, position - start);
+            }
+            used += width;
+            index += length;
+        }
+        position = text.size();
+        return TrimTrailingSpaces(text.substr(start));
+    }
+}
+
+wrap::LineWrapper::LineWrapper(std::string_view text, size_t limit, BreakKernel kernel)
+    : m_text(text)
+    , m_limit(limit)
+    , m_kernel(kernel)
+    , m_position(0)
+{
+    CheckLimit(limit);
+    m_position = SkipIndentation(text, limit, 0, ByteWidth);
+}
+
+bool wrap::LineWrapper::Next(std::string_view& line)
+{
+    if (m_position >= m_text.size())
+    {
+        return false;
+    }
+    const std::string_view window = GetWindow(m_text, m_limit, m_position);
+    line = NextByteLine(m_text, m_limit, FindBreaks(m_kernel, window.data(), window.size()), m_position);
+    m_position = SkipIndentation(m_text, m_limit, m_position, ByteWidth);
+    return true;
+}
+
+size_t wrap::LineWrapper::GetPosition() const
+{
+    return m_position;
+}
+
+std::vector<std::string> wrap::WrapText(std::string_view text, size_t limit)
+{
+    std::vector<std::string> lines;
+    ForEachLine(text, limit, [&lines](std::string_view line) { lines.emplace_back(line); });
+    return lines;
+}
+
+wrap::ColumnWrapper::ColumnWrapper(std::string_view text, size_t columns, BreakKernel kernel)
+    : m_text(text)
+    , m_columns(columns)
+    , m_kernel(kernel)
+    , m_position(0)
+{
+    CheckLimit(columns);
+    m_position = SkipIndentation(text, columns, 0, DisplayWidth);
+}
+
+bool wrap::ColumnWrapper::Next(std::string_view& line)
+{
+    if (m_position >= m_text.size())
+    {
+        return false;
+    }
+
+    // The line depends only on the window up to its break, so when that is ASCII bytes are columns
+    const std::string_view window = GetWindow(m_text, m_columns, m_position);
+    const Breaks breaks = FindBreaks(m_kernel, window.data(), window.size());
+    line = breaks.ascii ? NextByteLine(m_text, m_columns, breaks, m_position)
+                        : NextColumnLine(m_text, m_columns, m_position);
+    m_position = SkipIndentation(m_text, m_columns, m_position, DisplayWidth);
+    return true;
+}
+
+std::vector<std::string> wrap::WrapColumns(std::string_view text, size_t columns)
+{
+    std::vector<std::string> lines;
+    ColumnWrapper wrapper(text, columns);
+    std::string_view line;
+    while (wrapper.Next(line))
+    {
+        lines.emplace_back(line);
+    }
+    return lines;
+}
+
+wrap::OptimalWrapper::OptimalWrapper(std::string_view text, size_t limit)
+    : m_text(text)
+    , m_limit(limit)
+    , m_position(0)
+    , m_line(0)
+{
+    CheckLimit(limit);
+}
+
+bool wrap::OptimalWrapper::Next(std::string_view& line)
+{
+    if (m_line == m_lines.size())
+    {
+        if (m_position >= m_text.size())
+        {
+            return false;
+        }
+        const size_t newline = std::min(m_text.find('\n', m_position), m_text.size());
+        m_lines.clear();
+        m_line = 0;
+        m_fitter.Fit(m_text.substr(m_position, newline - m_position), m_limit, m_lines);
+        m_position = newline + 1;
+    }
+    line = m_lines[m_line++];
+    return true;
+}
+
+std::vector<std::string> wrap::WrapOptimal(std::string_view text, size_t limit)
+{
+    std::vector<std::string> lines;
+    OptimalWrapper wrapper(text, limit);
+    std::string_view line;
+    while (wrapper.Next(line))
+    {
+        lines.emplace_back(line);
+    }
+    return lines;
+}
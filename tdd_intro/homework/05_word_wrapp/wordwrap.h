@@ -0,0 +1,104 @@
+#pragma once
+#include "breakfinder.h"
+#include "optimalfit.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+ * Rules of wrapping:
+ *  - a line takes as many words as fit in the limit, the spaces where it breaks are dropped
+ *  - a word longer than the limit is cut at the limit
+ *  - '\n' always ends a line, so paragraphs and empty lines of the text are kept
+ *  - lines never end with a space
+ *  - indentation which doesn't fit together with the first word of its paragraph is dropped
+ */
+namespace wrap
+{
+    /*
+     * Lines of the text one by one, as views into the text.
+     * Keeps only the position in the text, so it wraps texts of any size without allocations.
+     * The text must outlive the wrapper and the lines.
+     */
+    class LineWrapper
+    {
+    public:
+        // Throws std::runtime_error for zero limit
+        LineWrapper(std::string_view text, size_t limit, BreakKernel kernel = GetBestBreakKernel());
+
+        // False when the text is over
+        bool Next(std::string_view& line);
+        // Where the next line starts, lines start right there and only their end is trimmed
+        size_t GetPosition() const;
+
+    private:
+        std::string_view m_text;
+        size_t m_limit;
+        BreakKernel m_kernel;
+        size_t m_position;
+    };
+
+    template<typename OnLine>
+    void ForEachLine(std::string_view text, size_t limit, OnLine onLine)
+    {
+        LineWrapper wrapper(text, limit);
+        std::string_view line;
+        while (wrapper.Next(line))
+        {
+            onLine(line);
+        }
+    }
+
+    // Copies of all lines, when they have to outlive the text
+    std::vector<std::string> WrapText(std::string_view text, size_t limit);
+
+    /*
+     * Same rules for UTF-8 text, but the limit is in terminal columns and lines break
+     * only between grapheme clusters. A cluster wider than the whole limit gets a line of its own.
+     * Lines whose window is pure ASCII are wrapped the way LineWrapper does it: the break search
+     * checks the same bytes for ASCII, so plain text is not slower than with bytes.
+     */
+    class ColumnWrapper
+    {
+    public:
+        // Throws std::runtime_error for zero limit
+        ColumnWrapper(std::string_view text, size_t columns, BreakKernel kernel = GetBestBreakKernel());
+
+        // False when the text is over
+        bool Next(std::string_view& line);
+
+    private:
+        std::string_view m_text;
+        size_t m_columns;
+        BreakKernel m_kernel;
+        size_t m_position;
+    };
+
+    std::vector<std::string> WrapColumns(std::string_view text, size_t columns);
+
+    /*
+     * Same rules, but paragraphs are broken the optimal-fit way (see ParagraphFitter) rather than greedily:
+     * lines of a paragraph come out evenly long instead of full ones followed by a short one.
+     * Fits a paragraph at a time, the memory it takes grows with the longest paragraph.
+     */
+    class OptimalWrapper
+    {
+    public:
+        // Throws std::runtime_error for zero limit
+        OptimalWrapper(std::string_view text, size_t limit);
+
+        // False when the text is over
+        bool Next(std::string_view& line);
+
+    private:
+        std::string_view m_text;
+        size_t m_limit;
+        size_t m_position;
+        ParagraphFitter m_fitter;
+        // Lines of the current paragraph
+        std::vector<std::string_view> m_lines;
+        size_t m_line;
+    };
+
+    std::vector<std::string> WrapOptimal(std::string_view text, size_t limit);
+}
@@ -2,9 +2,22 @@ include(../../gtest.pri)
 include(../../gmock.pri)
 
 TEMPLATE = app
-CONFIG += console c++11
+CONFIG += console c++17
 CONFIG -= app_bundle
 CONFIG -= qt
 
 SOURCES += \
-    test.cpp
+    test.cpp \
+    benchmark.cpp \
+    coffeemachine.cpp \
+    batchsourceadapter.cpp \
+    simulateddispenser.cpp
+
+HEADERS += \
+    isourceofingredients.h \
+    ibatchsourceofingredients.h \
+    mocks.h \
+    recipes.h \
+    coffeemachine.h \
+    batchsourceadapter.h \
+    simulateddispenser.h
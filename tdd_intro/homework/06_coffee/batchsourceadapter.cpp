@@ -0,0 +1,56 @@
+#include "batchsourceadapter.h"
+#include "coffeemachine.h"
+
+BatchSourceAdapter::BatchSourceAdapter(ISourceOfIngredients& source)
+    : m_source(source)
+{
+}
+
+void BatchSourceAdapter::SetCupSize(int gram)
+{
+    m_source.SetCupSize(gram);
+}
+
+void BatchSourceAdapter::AddWater(int gram, int temperature)
+{
+    m_source.AddWater(gram, temperature);
+}
+
+void BatchSourceAdapter::AddSugar(int gram)
+{
+    m_source.AddSugar(gram);
+}
+
+void BatchSourceAdapter::AddCoffee(int gram)
+{
+    m_source.AddCoffee(gram);
+}
+
+void BatchSourceAdapter::AddMilk(int gram)
+{
+    m_source.AddMilk(gram);
+}
+
+void BatchSourceAdapter::AddMilkFoam(int gram)
+{
+    m_source.AddMilkFoam(gram);
+}
+
+void BatchSourceAdapter::AddChocolate(int gram)
+{
+    m_source.AddChocolate(gram);
+}
+
+void BatchSourceAdapter::AddCream(int gram)
+{
+    m_source.AddCream(gram);
+}
+
+void BatchSourceAdapter::SubmitBatch(const Program& program)
+{
+    coffee::RunProgram(program, m_source);
+}
+
+void BatchSourceAdapter::Flush()
+{
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include "ibatchsourceofingredients.h"
+
+// Lets a source which knows only single calls be used where batches are expected.
+// A batch is unrolled into a call per command, and it is dispensed by the time the submit returns.
+class BatchSourceAdapter : public IBatchSourceOfIngredients
+{
+public:
+    explicit BatchSourceAdapter(ISourceOfIngredients& source);
+
+    void SetCupSize(int gram) override;
+    void AddWater(int gram, int temperature) override;
+    void AddSugar(int gram) override;
+    void AddCoffee(int gram) override;
+    void AddMilk(int gram) override;
+    void AddMilkFoam(int gram) override;
+    void AddChocolate(int gram) override;
+    void AddCream(int gram) override;
+
+    void SubmitBatch(const Program& program) override;
+    void Flush() override;
+
+private:
+    ISourceOfIngredients& m_source;
+};
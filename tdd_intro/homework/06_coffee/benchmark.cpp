@@ -0,0 +1,108 @@
+// Performance checks for the coffee machine.
+// They are disabled by default, run them with --gtest_also_run_disabled_tests --gtest_filter=*Benchmark*
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include "coffeemachine.h"
+#include "simulateddispenser.h"
+
+namespace
+{
+    // Sums what it is asked for, so the calls are not optimized away
+    class CountingSource : public ISourceOfIngredients
+    {
+    public:
+        void SetCupSize(int gram) override { grams += gram; }
+        void AddWater(int gram, int temperature) override { grams += gram + temperature; }
+        void AddSugar(int gram) override { grams += gram; }
+        void AddCoffee(int gram) override { grams += gram; }
+        void AddMilk(int gram) override { grams += gram; }
+        void AddMilkFoam(int gram) override { grams += gram; }
+        void AddChocolate(int gram) override { grams += gram; }
+        void AddCream(int gram) override { grams += gram; }
+
+        long long grams = 0;
+    };
+
+    const int s_drinksCount = 10 * 1000 * 1000;
+
+    // Bus and dispenser of a real machine are about this slow, a drink dispenses about as long as its round trip
+    const std::chrono::microseconds s_roundTrip(2000);
+    const std::chrono::microseconds s_dispenseTime(500);
+    const int s_dispensedDrinksCount = 50;
+
+    template<typename Action>
+    double MeasureSeconds(Action action)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        action();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+TEST(CoffeeMachineBenchmark, DISABLED_Programs)
+{
+    CountingSource compiledSource;
+    CoffeeMachine machine(compiledSource);
+    const double compiled = MeasureSeconds([&]()
+    {
+        for (int drink = 0; drink < s_drinksCount; ++drink)
+        {
+            machine.Make(static_cast<Drink>(drink % g_menuDrinksCount), static_cast<CupSize>(drink / 4 % 2));
+        }
+    });
+
+    // The recipe is worked out again for every drink
+    CountingSource recipeSource;
+    const double recipes = MeasureSeconds([&]()
+    {
+        for (int drink = 0; drink < s_drinksCount; ++drink)
+        {
+            const CupSize size = static_cast<CupSize>(drink / 4 % 2);
+            const Recipe& recipe = coffee::g_menu[drink % g_menuDrinksCount][static_cast<size_t>(size)];
+            coffee::RunProgram(coffee::CompileRecipe(recipe, size), recipeSource);
+        }
+    });
+
+    EXPECT_EQ(recipeSource.grams, compiledSource.grams);
+    std::cout << "compiled programs: " << s_drinksCount / compiled / 1e6 << " M drinks/sec" << std::endl;
+    std::cout << "recipes per drink: " << s_drinksCount / recipes / 1e6 << " M drinks/sec, slowdown "
+              << recipes / compiled << std::endl;
+}
+
+TEST(CoffeeMachineBenchmark, DISABLED_Batches)
+{
+    const auto makeDrinks = [](CoffeeMachine& machine, bool pipelined)
+    {
+        for (int drink = 0; drink < s_dispensedDrinksCount; ++drink)
+        {
+            const Drink kind = static_cast<Drink>(drink % g_menuDrinksCount);
+            const CupSize size = static_cast<CupSize>(drink / 4 % 2);
+            pipelined ? machine.Order(kind, size) : machine.Make(kind, size);
+        }
+        machine.WaitForOrders();
+    };
+
+    // The dispenser is seen as a source without batches, every ingredient is a call
+    SimulatedDispenser callsDispenser(s_roundTrip, s_dispenseTime);
+    BatchSourceAdapter callsSource(static_cast<ISourceOfIngredients&>(callsDispenser));
+    CoffeeMachine callsMachine(callsSource);
+    const double calls = MeasureSeconds([&]() { makeDrinks(callsMachine, false); });
+
+    SimulatedDispenser batchDispenser(s_roundTrip, s_dispenseTime);
+    CoffeeMachine batchMachine(batchDispenser);
+    const double batches = MeasureSeconds([&]() { makeDrinks(batchMachine, false); });
+
+    SimulatedDispenser pipelinedDispenser(s_roundTrip, s_dispenseTime);
+    CoffeeMachine pipelinedMachine(pipelinedDispenser);
+    const double pipelined = MeasureSeconds([&]() { makeDrinks(pipelinedMachine, true); });
+
+    EXPECT_EQ(callsDispenser.GetDispensed(), batchDispenser.GetDispensed());
+    EXPECT_EQ(callsDispenser.GetDispensed(), pipelinedDispenser.GetDispensed());
+    std::cout << "call per ingredient: " << s_dispensedDrinksCount / calls << " drinks/sec, "
+              << callsDispenser.GetRoundTrips() << " round trips" << std::endl;
+    std::cout << "batch per drink: " << s_dispensedDrinksCount / batches << " drinks/sec, "
+              << batchDispenser.GetRoundTrips() << " round trips, speedup " << calls / batches << std::endl;
+    std::cout << "pipelined batches: " << s_dispensedDrinksCount / pipelined << " drinks/sec, speedup "
+              << calls / pipelined << std::endl;
+}
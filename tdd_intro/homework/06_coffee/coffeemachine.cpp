@@ -0,0 +1,83 @@
+#include "coffeemachine.h"
+
+namespace
+{
+    IBatchSourceOfIngredients* GetBatchSource(ISourceOfIngredients& source)
+    {
+        return dynamic_cast<IBatchSourceOfIngredients*>(&source);
+    }
+}
+
+CoffeeMachine::CoffeeMachine(ISourceOfIngredients& source)
+    : m_adapter(GetBatchSource(source) == nullptr ? std::make_unique<BatchSourceAdapter>(source) : nullptr)
+    , m_source(m_adapter != nullptr ? *m_adapter : *GetBatchSource(source))
+    , m_programs(coffee::g_menuPrograms.begin(), coffee::g_menuPrograms.end())
+{
+}
+
+void CoffeeMachine::Make(Drink drink, CupSize size)
+{
+    Order(drink, size);
+    WaitForOrders();
+}
+
+void CoffeeMachine::Order(Drink drink, CupSize size)
+{
+    m_source.SubmitBatch(GetProgram(drink, size));
+}
+
+void CoffeeMachine::WaitForOrders()
+{
+    m_source.Flush();
+}
+
+Drink CoffeeMachine::AddDrink(const Recipe& little, const Recipe& big)
+{
+    m_programs.push_back({ coffee::CompileRecipe(little, CupSize::Little), coffee::CompileRecipe(big, CupSize::Big) });
+    return static_cast<Drink>(m_programs.size() - 1);
+}
+
+const Program& CoffeeMachine::GetProgram(Drink drink, CupSize size) const
+{
+    const size_t index = static_cast<size_t>(drink);
+    if (index >= m_programs.size())
+    {
+        throw std::runtime_error("unknown drink");
+    }
+    return m_programs[index][static_cast<size_t>(size)];
+}
+
+void coffee::RunProgram(const Program& program, ISourceOfIngredients& source)
+{
+    for (size_t index = 0; index < program.count; ++index)
+    {
+        const Command& command = program.commands[index];
+        switch (command.operation)
+        {
+        case Command::SetCupSize:
+            source.SetCupSize(command.gram);
+            break;
+        case Command::AddWater:
+            source.AddWater(command.gram, command.temperature);
+            break;
+        case Command::AddSugar:
+            source.AddSugar(command.gram);
+            break;
+        case Command::AddCoffee:
+            source.AddCoffee(command.gram);
+            break;
+        case Command::AddMilk:
+            source.AddMilk(command.gram);
+            break;
+        case Command::AddMilkFoam:
+            source.AddMilkFoam(command.gram);
+            break;
+        case Command::AddChocolate:
+            source.AddChocolate(command.gram);
+            break;
+        case Command::AddCream:
+            source.AddCream(command.gram);
+            break;
+        }
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include "ibatchsourceofingredients.h"
+#include "batchsourceadapter.h"
+#include "recipes.h"
+#include <memory>
+#include <vector>
+
+/*
+ * Makes drinks with a source of ingredients. Every drink and cup size is a program compiled
+ * from its recipe beforehand, at compile time for the menu, so making a drink only replays the program.
+ * A source which takes batches gets the program of a drink in one call, others get a call per command.
+ */
+class CoffeeMachine
+{
+public:
+    explicit CoffeeMachine(ISourceOfIngredients& source);
+
+    // Returns when the drink is dispensed. Throws std::runtime_error for a drink the machine doesn't know.
+    void Make(Drink drink, CupSize size);
+    // Sends the drink without waiting for the drinks ordered before it to be dispensed
+    void Order(Drink drink, CupSize size);
+    void WaitForOrders();
+
+    // New drinks are data: the recipes are compiled here once. Returns the drink to make it with.
+    // Throws std::runtime_error for a recipe which doesn't fit the cup.
+    Drink AddDrink(const Recipe& little, const Recipe& big);
+
+    const Program& GetProgram(Drink drink, CupSize size) const;
+
+private:
+    // Only for a source without batches
+    std::unique_ptr<BatchSourceAdapter> m_adapter;
+    IBatchSourceOfIngredients& m_source;
+    std::vector<std::array<Program, g_cupSizesCount>> m_programs;
+};
+
+namespace coffee
+{
+    void RunProgram(const Program& program, ISourceOfIngredients& source);
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include "isourceofingredients.h"
+#include "recipes.h"
+
+/*
+ * Source which takes the program of a whole drink in a single round trip.
+ * Drinks are dispensed in the order they were submitted, a submit returns as soon as the source has the program,
+ * so the next drink can be on its way while the one before it is still being dispensed.
+ */
+class IBatchSourceOfIngredients : public ISourceOfIngredients
+{
+public:
+    virtual void SubmitBatch(const Program& program) = 0;
+    // Returns when all submitted drinks are dispensed
+    virtual void Flush() = 0;
+};
@@ -0,0 +1,31 @@
+#pragma once
+#include <gmock/gmock.h>
+#include "ibatchsourceofingredients.h"
+
+class SourceOfIngredientsMock : public ISourceOfIngredients
+{
+public:
+    MOCK_METHOD1(SetCupSize, void(int gram));
+    MOCK_METHOD2(AddWater, void(int gram, int temperature));
+    MOCK_METHOD1(AddSugar, void(int gram));
+    MOCK_METHOD1(AddCoffee, void(int gram));
+    MOCK_METHOD1(AddMilk, void(int gram));
+    MOCK_METHOD1(AddMilkFoam, void(int gram));
+    MOCK_METHOD1(AddChocolate, void(int gram));
+    MOCK_METHOD1(AddCream, void(int gram));
+};
+
+class BatchSourceOfIngredientsMock : public IBatchSourceOfIngredients
+{
+public:
+    MOCK_METHOD1(SetCupSize, void(int gram));
+    MOCK_METHOD2(AddWater, void(int gram, int temperature));
+    MOCK_METHOD1(AddSugar, void(int gram));
+    MOCK_METHOD1(AddCoffee, void(int gram));
+    MOCK_METHOD1(AddMilk, void(int gram));
+    MOCK_METHOD1(AddMilkFoam, void(int gram));
+    MOCK_METHOD1(AddChocolate, void(int gram));
+    MOCK_METHOD1(AddCream, void(int gram));
+    MOCK_METHOD1(SubmitBatch, void(const Program& program));
+    MOCK_METHOD0(Flush, void());
+};
@@ -0,0 +1,208 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+
+enum class CupSize
+{
+    Little,
+    Big
+};
+
+const size_t g_cupSizesCount = 2;
+const int g_littleCupGrams = 100;
+const int g_bigCupGrams = 140;
+
+enum class Ingredient
+{
+    Water,
+    Sugar,
+    Coffee,
+    Milk,
+    MilkFoam,
+    Chocolate,
+    Cream
+};
+
+// Share of the cup an ingredient takes, what is left of the cup stays empty
+struct Part
+{
+    Ingredient ingredient;
+    int numerator;
+    int denominator;
+};
+
+const size_t g_maxParts = 7;
+
+// Only water has a temperature in ISourceOfIngredients, it is the temperature of the recipe
+struct Recipe
+{
+    std::array<Part, g_maxParts> parts;
+    size_t partsCount;
+    int temperature;
+};
+
+// A call to ISourceOfIngredients
+struct Command
+{
+    enum Operation
+    {
+        SetCupSize,
+        AddWater,
+        AddSugar,
+        AddCoffee,
+        AddMilk,
+        AddMilkFoam,
+        AddChocolate,
+        AddCream
+    };
+
+    Operation operation;
+    int gram;
+    // Of water only
+    int temperature;
+};
+
+// Calls that prepare a drink in a cup of some size: the cup first, then the parts in the order of the recipe
+struct Program
+{
+    std::array<Command, g_maxParts + 1> commands;
+    size_t count;
+};
+
+constexpr bool operator==(const Command& left, const Command& right)
+{
+    return left.operation == right.operation && left.gram == right.gram && left.temperature == right.temperature;
+}
+
+constexpr bool operator==(const Program& left, const Program& right)
+{
+    if (left.count != right.count)
+    {
+        return false;
+    }
+    for (size_t index = 0; index < left.count; ++index)
+    {
+        if (!(left.commands[index] == right.commands[index]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+enum class Drink
+{
+    Americano,
+    Cappuccino,
+    Latte,
+    Marochino,
+    // Drinks added to a machine go after the menu
+    FirstCustom
+};
+
+const size_t g_menuDrinksCount = static_cast<size_t>(Drink::FirstCustom);
+
+namespace coffee
+{
+    constexpr int GetCupGrams(CupSize size)
+    {
+        return size == CupSize::Little ? g_littleCupGrams : g_bigCupGrams;
+    }
+
+    constexpr Command::Operation GetOperation(Ingredient ingredient)
+    {
+        switch (ingredient)
+        {
+        case Ingredient::Water:
+            return Command::AddWater;
+        case Ingredient::Sugar:
+            return Command::AddSugar;
+        case Ingredient::Coffee:
+            return Command::AddCoffee;
+        case Ingredient::Milk:
+            return Command::AddMilk;
+        case Ingredient::MilkFoam:
+            return Command::AddMilkFoam;
+        case Ingredient::Chocolate:
+            return Command::AddChocolate;
+        default:
+            return Command::AddCream;
+        }
+    }
+
+    // Grams of every part are rounded down. Throws std::runtime_error for a recipe which doesn't fit the cup,
+    // and doesn't compile when the recipe is a constant.
+    constexpr Program CompileRecipe(const Recipe& recipe, CupSize size)
+    {
+        if (recipe.partsCount > g_maxParts)
+        {
+            throw std::runtime_error("too many parts in the recipe");
+        }
+
+        const int cup = GetCupGrams(size);
+        Program program = {};
+        program.commands[program.count++] = { Command::SetCupSize, cup, 0 };
+        int total = 0;
+        for (size_t index = 0; index < recipe.partsCount; ++index)
+        {
+            const Part& part = recipe.parts[index];
+            if (part.numerator < 0 || part.denominator <= 0)
+            {
+                throw std::runtime_error("invalid share of the cup in the recipe");
+            }
+            const int gram = cup * part.numerator / part.denominator;
+            const int temperature = part.ingredient == Ingredient::Water ? recipe.temperature : 0;
+            program.commands[program.count++] = { GetOperation(part.ingredient), gram, temperature };
+            total += gram;
+        }
+        if (total > cup)
+        {
+            throw std::runtime_error("recipe doesn't fit the cup");
+        }
+        return program;
+    }
+
+    /*
+     * Recipes of the menu for the little and the big cup:
+     * - americano: coffee & water 1:2 in the little cup and 1:3 in the big one, water 60C
+     * - cappuccino: milk, coffee, milk foam, a third each, 80C
+     * - latte: milk a quarter, coffee a half, milk foam a quarter, 90C
+     * - marochino: chocolate, coffee, milk foam, a quarter each, the last quarter is empty
+     * Cappuccino, latte and marochino have no water, so their temperature is not sent anywhere.
+     */
+    constexpr Recipe g_menu[g_menuDrinksCount][g_cupSizesCount] = {
+        {
+            { { { { Ingredient::Water, 2, 3 }, { Ingredient::Coffee, 1, 3 } } }, 2, 60 },
+            { { { { Ingredient::Water, 3, 4 }, { Ingredient::Coffee, 1, 4 } } }, 2, 60 }
+        },
+        {
+            { { { { Ingredient::Milk, 1, 3 }, { Ingredient::Coffee, 1, 3 }, { Ingredient::MilkFoam, 1, 3 } } }, 3, 80 },
+            { { { { Ingredient::Milk, 1, 3 }, { Ingredient::Coffee, 1, 3 }, { Ingredient::MilkFoam, 1, 3 } } }, 3, 80 }
+        },
+        {
+            { { { { Ingredient::Milk, 1, 4 }, { Ingredient::Coffee, 1, 2 }, { Ingredient::MilkFoam, 1, 4 } } }, 3, 90 },
+            { { { { Ingredient::Milk, 1, 4 }, { Ingredient::Coffee, 1, 2 }, { Ingredient::MilkFoam, 1, 4 } } }, 3, 90 }
+        },
+        {
+            { { { { Ingredient::Chocolate, 1, 4 }, { Ingredient::Coffee, 1, 4 }, { Ingredient::MilkFoam, 1, 4 } } }, 3, 0 },
+            { { { { Ingredient::Chocolate, 1, 4 }, { Ingredient::Coffee, 1, 4 }, { Ingredient::MilkFoam, 1, 4 } } }, 3, 0 }
+        }
+    };
+
+    typedef std::array<std::array<Program, g_cupSizesCount>, g_menuDrinksCount> MenuPrograms;
+
+    constexpr MenuPrograms CompileMenu()
+    {
+        MenuPrograms programs = {};
+        for (size_t drink = 0; drink < g_menuDrinksCount; ++drink)
+        {
+            programs[drink][0] = CompileRecipe(g_menu[drink][0], CupSize::Little);
+            programs[drink][1] = CompileRecipe(g_menu[drink][1], CupSize::Big);
+        }
+        return programs;
+    }
+
+    // Compiled with the machine, making a drink of the menu only replays its program
+    constexpr MenuPrograms g_menuPrograms = CompileMenu();
+}
@@ -0,0 +1,138 @@
+#include "simulateddispenser.h"
+
+SimulatedDispenser::SimulatedDispenser(std::chrono::microseconds roundTrip, std::chrono::microseconds dispenseTime)
+    : m_roundTrip(roundTrip)
+    , m_dispenseTime(dispenseTime)
+    , m_dispensing(false)
+    , m_stopping(false)
+    , m_roundTrips(0)
+    , m_worker(&SimulatedDispenser::Work, this)
+{
+}
+
+SimulatedDispenser::~SimulatedDispenser()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_changed.notify_all();
+    m_worker.join();
+}
+
+void SimulatedDispenser::SetCupSize(int gram)
+{
+    Call({ Command::SetCupSize, gram, 0 });
+}
+
+void SimulatedDispenser::AddWater(int gram, int temperature)
+{
+    Call({ Command::AddWater, gram, temperature });
+}
+
+void SimulatedDispenser::AddSugar(int gram)
+{
+    Call({ Command::AddSugar, gram, 0 });
+}
+
+void SimulatedDispenser::AddCoffee(int gram)
+{
+    Call({ Command::AddCoffee, gram, 0 });
+}
+
+void SimulatedDispenser::AddMilk(int gram)
+{
+    Call({ Command::AddMilk, gram, 0 });
+}
+
+void SimulatedDispenser::AddMilkFoam(int gram)
+{
+    Call({ Command::AddMilkFoam, gram, 0 });
+}
+
+void SimulatedDispenser::AddChocolate(int gram)
+{
+    Call({ Command::AddChocolate, gram, 0 });
+}
+
+void SimulatedDispenser::AddCream(int gram)
+{
+    Call({ Command::AddCream, gram, 0 });
+}
+
+void SimulatedDispenser::SubmitBatch(const Program& program)
+{
+    RoundTrip();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push_back(program);
+    }
+    m_changed.notify_all();
+}
+
+void SimulatedDispenser::Flush()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_changed.wait(lock, [this]() { return m_queue.empty() && !m_dispensing; });
+}
+
+std::vector<Command> SimulatedDispenser::GetDispensed() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_dispensed;
+}
+
+size_t SimulatedDispenser::GetRoundTrips() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_roundTrips;
+}
+
+void SimulatedDispenser::Call(const Command& command)
+{
+    Flush();
+    RoundTrip();
+    Dispense(command);
+}
+
+void SimulatedDispenser::RoundTrip()
+{
+    std::this_thread::sleep_for(m_roundTrip);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_roundTrips;
+}
+
+void SimulatedDispenser::Dispense(const Command& command)
+{
+    std::this_thread::sleep_for(m_dispenseTime);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_dispensed.push_back(command);
+}
+
+void SimulatedDispenser::Work()
+{
+    for (;;)
+    {
+        Program program;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_changed.wait(lock, [this]() { return m_stopping || !m_queue.empty(); });
+            if (m_queue.empty())
+            {
+                return;
+            }
+            program = m_queue.front();
+            m_queue.pop_front();
+            m_dispensing = true;
+        }
+        for (size_t index = 0; index < program.count; ++index)
+        {
+            Dispense(program.commands[index]);
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_dispensing = false;
+        }
+        m_changed.notify_all();
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include "ibatchsourceofingredients.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Dispenser behind a slow control bus. A call takes a round trip over the bus in the calling thread,
+ * a batch takes one round trip for the whole drink. The dispenser works through the submitted drinks
+ * on its own, dispenseTime per command, so the bus is free for the next drink meanwhile.
+ * Single calls know nothing of the queue: they wait for the drinks before them and for their own ingredient.
+ */
+class SimulatedDispenser : public IBatchSourceOfIngredients
+{
+public:
+    SimulatedDispenser(std::chrono::microseconds roundTrip, std::chrono::microseconds dispenseTime);
+    ~SimulatedDispenser();
+
+    SimulatedDispenser(const SimulatedDispenser&) = delete;
+    SimulatedDispenser& operator=(const SimulatedDispenser&) = delete;
+
+    void SetCupSize(int gram) override;
+    void AddWater(int gram, int temperature) override;
+    void AddSugar(int gram) override;
+    void AddCoffee(int gram) override;
+    void AddMilk(int gram) override;
+    void AddMilkFoam(int gram) override;
+    void AddChocolate(int gram) override;
+    void AddCream(int gram) override;
+
+    void SubmitBatch(const Program& program) override;
+    void Flush() override;
+
+    // In the order they were dispensed
+    std::vector<Command> GetDispensed() const;
+    size_t GetRoundTrips() const;
+
+private:
+    void Call(const Command& command);
+    void RoundTrip();
+    void Dispense(const Command& command);
+    void Work();
+
+    std::chrono::microseconds m_roundTrip;
+    std::chrono::microseconds m_dispenseTime;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_changed;
+    std::deque<Program> m_queue;
+    // The drink taken from the queue is not dispensed yet
+    bool m_dispensing;
+    bool m_stopping;
+    std::vector<Command> m_dispensed;
+    size_t m_roundTrips;
+    std::thread m_worker;
+};
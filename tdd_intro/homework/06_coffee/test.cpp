@@ -16,17 +16,157 @@ Implement worked coffee machine using ISourceOfIngredients to controll the proce
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
+#include "mocks.h"
+#include "coffeemachine.h"
+#include "simulateddispenser.h"
 
-class ISourceOfIngredients
-{
-public:
-    virtual ~ISourceOfIngredients() {}
-    virtual void SetCupSize(int gram) = 0;
-    virtual void AddWater(int gram, int temperature) = 0;
-    virtual void AddSugar(int gram) = 0;
-    virtual void AddCoffee(int gram) = 0;
-    virtual void AddMilk(int gram) = 0;
-    virtual void AddMilkFoam(int gram) = 0;
-    virtual void AddChocolate(int gram) = 0;
-    virtual void AddCream(int gram) = 0;
-};
+using testing::InSequence;
+using testing::StrictMock;
+
+namespace
+{
+    // Checked while the tests compile
+    static_assert(coffee::g_menuPrograms[static_cast<size_t>(Drink::Latte)][1].count == 4, "cup and three parts");
+    static_assert(coffee::g_menuPrograms[static_cast<size_t>(Drink::Latte)][1].commands[2].gram == 70, "half of the big cup");
+
+    const Recipe s_irishCoffee = {
+        { { { Ingredient::Coffee, 1, 2 }, { Ingredient::Sugar, 1, 20 }, { Ingredient::Cream, 1, 4 } } }, 3, 0
+    };
+}
+
+TEST(CoffeeMachine, Americano)
+{
+    StrictMock<SourceOfIngredientsMock> source;
+    CoffeeMachine machine(source);
+    InSequence sequence;
+    EXPECT_CALL(source, SetCupSize(100));
+    EXPECT_CALL(source, AddWater(66, 60));
+    EXPECT_CALL(source, AddCoffee(33));
+    EXPECT_CALL(source, SetCupSize(140));
+    EXPECT_CALL(source, AddWater(105, 60));
+    EXPECT_CALL(source, AddCoffee(35));
+
+    machine.Make(Drink::Americano, CupSize::Little);
+    machine.Make(Drink::Americano, CupSize::Big);
+}
+
+TEST(CoffeeMachine, Cappuccino)
+{
+    StrictMock<SourceOfIngredientsMock> source;
+    CoffeeMachine machine(source);
+    InSequence sequence;
+    EXPECT_CALL(source, SetCupSize(140));
+    EXPECT_CALL(source, AddMilk(46));
+    EXPECT_CALL(source, AddCoffee(46));
+    EXPECT_CALL(source, AddMilkFoam(46));
+
+    machine.Make(Drink::Cappuccino, CupSize::Big);
+}
+
+TEST(CoffeeMachine, Latte)
+{
+    StrictMock<SourceOfIngredientsMock> source;
+    CoffeeMachine machine(source);
+    InSequence sequence;
+    EXPECT_CALL(source, SetCupSize(100));
+    EXPECT_CALL(source, AddMilk(25));
+    EXPECT_CALL(source, AddCoffee(50));
+    EXPECT_CALL(source, AddMilkFoam(25));
+
+    machine.Make(Drink::Latte, CupSize::Little);
+}
+
+TEST(CoffeeMachine, Marochino)
+{
+    StrictMock<SourceOfIngredientsMock> source;
+    CoffeeMachine machine(source);
+    InSequence sequence;
+    EXPECT_CALL(source, SetCupSize(140));
+    EXPECT_CALL(source, AddChocolate(35));
+    EXPECT_CALL(source, AddCoffee(35));
+    EXPECT_CALL(source, AddMilkFoam(35));
+
+    machine.Make(Drink::Marochino, CupSize::Big);
+}
+
+TEST(CoffeeMachine, RecipesAreData)
+{
+    StrictMock<SourceOfIngredientsMock> source;
+    CoffeeMachine machine(source);
+    const Drink irishCoffee = machine.AddDrink(s_irishCoffee, s_irishCoffee);
+    EXPECT_EQ(Drink::FirstCustom, irishCoffee);
+
+    InSequence sequence;
+    EXPECT_CALL(source, SetCupSize(100));
+    EXPECT_CALL(source, AddCoffee(50));
+    EXPECT_CALL(source, AddSugar(5));
+    EXPECT_CALL(source, AddCream(25));
+    machine.Make(irishCoffee, CupSize::Little);
+}
+
+TEST(CoffeeMachine, InvalidRecipesAndDrinks)
+{
+    StrictMock<SourceOfIngredientsMock> source;
+    CoffeeMachine machine(source);
+    const Recipe overflowing = { { { { Ingredient::Milk, 2, 3 }, { Ingredient::Coffee, 1, 2 } } }, 2, 0 };
+    const Recipe broken = { { { { Ingredient::Milk, 1, 0 } } }, 1, 0 };
+    EXPECT_THROW(machine.AddDrink(overflowing, s_irishCoffee), std::runtime_error);
+    EXPECT_THROW(machine.AddDrink(s_irishCoffee, broken), std::runtime_error);
+    EXPECT_THROW(machine.Make(Drink::FirstCustom, CupSize::Big), std::runtime_error);
+}
+
+TEST(CoffeeMachine, BatchSourceGetsDrinkInOneCall)
+{
+    StrictMock<BatchSourceOfIngredientsMock> source;
+    CoffeeMachine machine(source);
+    InSequence sequence;
+    EXPECT_CALL(source, SubmitBatch(coffee::g_menuPrograms[static_cast<size_t>(Drink::Latte)][1]));
+    EXPECT_CALL(source, Flush());
+    EXPECT_CALL(source, SubmitBatch(coffee::g_menuPrograms[static_cast<size_t>(Drink::Americano)][0]));
+    EXPECT_CALL(source, SubmitBatch(coffee::g_menuPrograms[static_cast<size_t>(Drink::Marochino)][0]));
+    EXPECT_CALL(source, Flush());
+
+    machine.Make(Drink::Latte, CupSize::Big);
+    machine.Order(Drink::Americano, CupSize::Little);
+    machine.Order(Drink::Marochino, CupSize::Little);
+    machine.WaitForOrders();
+}
+
+TEST(CoffeeMachine, AdapterUnrollsBatches)
+{
+    StrictMock<SourceOfIngredientsMock> source;
+    BatchSourceAdapter adapter(source);
+    InSequence sequence;
+    EXPECT_CALL(source, SetCupSize(140));
+    EXPECT_CALL(source, AddWater(105, 60));
+    EXPECT_CALL(source, AddCoffee(35));
+    EXPECT_CALL(source, AddSugar(3));
+
+    adapter.SubmitBatch(coffee::g_menuPrograms[static_cast<size_t>(Drink::Americano)][1]);
+    adapter.Flush();
+    adapter.AddSugar(3);
+}
+
+TEST(CoffeeMachine, OrdersAreDispensedInOrder)
+{
+    SimulatedDispenser dispenser(std::chrono::microseconds(100), std::chrono::microseconds(100));
+    CoffeeMachine machine(dispenser);
+    std::vector<Command> expected;
+    const std::pair<Drink, CupSize> orders[] = {
+        { Drink::Cappuccino, CupSize::Little }, { Drink::Latte, CupSize::Big }, { Drink::Americano, CupSize::Big }
+    };
+    for (const auto& order : orders)
+    {
+        machine.Order(order.first, order.second);
+        const Program& program = machine.GetProgram(order.first, order.second);
+        expected.insert(expected.end(), program.commands.begin(), program.commands.begin() + program.count);
+    }
+    machine.WaitForOrders();
+    EXPECT_EQ(3u, dispenser.GetRoundTrips());
+    EXPECT_EQ(expected, dispenser.GetDispensed());
+
+    // A single call waits for the drinks before it
+    machine.Order(Drink::Latte, CupSize::Little);
+    dispenser.AddSugar(5);
+    EXPECT_EQ(Command({ Command::AddSugar, 5, 0 }), dispenser.GetDispensed().back());
+}